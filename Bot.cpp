@@ -1,81 +1,305 @@
 #include "Bot.h"
 
-Bot::Bot(int num, int ID)
+uint64_t Bot::masterSeed = 0;
+
+
+// Hit mask of the proximity queries, shared by the bots of each thread
+static thread_local vector<uint64_t> hits;
+
+
+Bot::Bot(int ID)
 {
 	botID = ID;
-	numPlayers = num;
-	players = new Player[numPlayers];
-	
-	// Initialize all the bots
-	for (int i = 0; i < numPlayers; i++)
-	{
-		players[i].isCreated = false;
-		players[i].isAlive = false;
-	}
 	
 	// Set this bot as created
-	players[botID].isCreated = true;
-	players[botID].score = 0;
+	self.isCreated = true;
+	self.isAlive = false;
+	self.x = 0;
+	self.y = 0;
+	self.z = 0;
+	self.score = 0;
 	
 	// Set the last action time as negative to indicate that player has not taken any action
 	lastActionTime = -1;
 	
+	// Each bot draws from its own stream, so that bots don't move in lockstep
+	random.seed(masterSeed, (uint32_t)ID);
+	
 	// No killer of this bot yet
 	killerID = -1;
+	
+	decisionTime = 0;
 }
 
 
 Bot::~Bot()
 {
-	if (players != NULL) delete[] players;
 }
 
 
-float Bot::getDistance(int32_t playerID1, int32_t playerID2)
+float Bot::getDistance(const Target& target)
 {
-	float x = abs(players[playerID1].x - players[playerID2].x);
-	float y = abs(players[playerID1].y - players[playerID2].y);
-	float z = abs(players[playerID1].z - players[playerID2].z);
+	float x = abs(self.x - target.x);
+	float y = abs(self.y - target.y);
+	float z = abs(self.z - target.z);
 	
 	return sqrt(x * x + y * y + z * z);
 }
 
 
+void Bot::predictPositions()
+{
+	decisionTime = getTime();
+}
+
+
+uint32_t Bot::countPlayersInRadius(float x, float y, float z, float radius)
+{
+	uint32_t count = 0;
+	
+	if (world) count = world->players.findInRadius(x, y, z, radius, decisionTime, staleSlots, hits);
+	
+	for (size_t i = 0; i < spawns.size(); i++)
+	{
+		float dx = spawns[i].x - x;
+		float dy = spawns[i].y - y;
+		float dz = spawns[i].z - z;
+		
+		if (dx * dx + dy * dy + dz * dz <= radius * radius) count++;
+	}
+	
+	return count;
+}
+
+
+bool Bot::findTarget(Target& target)
+{
+	float radiusSquared = EXPLOSION_RADIUS * EXPLOSION_RADIUS;
+	
+	// The players that just spawned have not moved yet
+	for (size_t i = 0; i < spawns.size(); i++)
+	{
+		target.id = spawns[i].id;
+		target.x = spawns[i].x;
+		target.y = spawns[i].y;
+		target.z = spawns[i].z;
+		
+		float dx = target.x - self.x;
+		float dy = target.y - self.y;
+		float dz = target.z - self.z;
+		
+		if (dx * dx + dy * dy + dz * dz <= radiusSquared) return true;
+	}
+	
+	if (!world) return false;
+	
+	int32_t slot = world->players.findAnyInRadius(self.x, self.y, self.z, EXPLOSION_RADIUS, decisionTime, staleSlots);
+	
+	if (slot == -1) return false;
+	
+	target.id = world->players.getID(slot);
+	world->players.estimatePosition(slot, decisionTime, target.x, target.y, target.z);
+	
+	return true;
+}
+
+
+bool Bot::findNearest(Target& target)
+{
+	bool found = false;
+	float bestSquared = 0;
+	
+	if (world)
+	{
+		int32_t slot = world->players.findNearest(self.x, self.y, self.z, decisionTime, staleSlots);
+		
+		if (slot != -1)
+		{
+			target.id = world->players.getID(slot);
+			world->players.estimatePosition(slot, decisionTime, target.x, target.y, target.z);
+			
+			float dx = target.x - self.x;
+			float dy = target.y - self.y;
+			float dz = target.z - self.z;
+			
+			bestSquared = dx * dx + dy * dy + dz * dz;
+			found = true;
+		}
+	}
+	
+	for (size_t i = 0; i < spawns.size(); i++)
+	{
+		float dx = spawns[i].x - self.x;
+		float dy = spawns[i].y - self.y;
+		float dz = spawns[i].z - self.z;
+		float distanceSquared = dx * dx + dy * dy + dz * dz;
+		
+		if (!found || distanceSquared < bestSquared)
+		{
+			target.id = spawns[i].id;
+			target.x = spawns[i].x;
+			target.y = spawns[i].y;
+			target.z = spawns[i].z;
+			
+			bestSquared = distanceSquared;
+			found = true;
+		}
+	}
+	
+	return found;
+}
+
+
+bool Bot::findPlayer(int playerID, Target& target)
+{
+	int index = findSpawn(playerID);
+	
+	if (index != -1)
+	{
+		target.id = playerID;
+		target.x = spawns[index].x;
+		target.y = spawns[index].y;
+		target.z = spawns[index].z;
+		return true;
+	}
+	
+	if (!world) return false;
+	
+	int32_t slot = world->players.find(playerID);
+	
+	if (slot == -1 || !world->players.isAlive(slot)) return false;
+	
+	// The player was killed or respawned since the snapshot
+	for (size_t i = 0; i < staleSlots.size(); i++)
+	{
+		if (staleSlots[i] == slot) return false;
+	}
+	
+	target.id = playerID;
+	world->players.estimatePosition(slot, decisionTime, target.x, target.y, target.z);
+	
+	return true;
+}
+
+
+void Bot::ignoreSlot(int32_t slot)
+{
+	for (size_t i = 0; i < staleSlots.size(); i++)
+	{
+		if (staleSlots[i] == slot) return;
+	}
+	
+	staleSlots.push_back(slot);
+}
+
+
+int Bot::findSpawn(int playerID)
+{
+	for (size_t i = 0; i < spawns.size(); i++)
+	{
+		if (spawns[i].id == playerID) return i;
+	}
+	
+	return -1;
+}
+
+
 bool Bot::coolDownDone()
 {	
 	if (lastActionTime < 0) return true; // if player has not taken any action
 	
-	float sec = (clock() - lastActionTime)/(double)CLOCKS_PER_SEC;
+	return getTime() - lastActionTime >= ACTION_COOLDOWN_NANOS;
+}
+
+
+int64_t Bot::getNextActionTime()
+{
+	if (lastActionTime < 0) return 0; // if player has not taken any action
 	
-	return (sec >= ACTION_COOLDOWN);
+	return lastActionTime + ACTION_COOLDOWN_NANOS;
+}
+
+
+void Bot::setMasterSeed(uint64_t seed)
+{
+	masterSeed = seed;
+}
+
+
+int64_t Bot::getTime()
+{
+	return monotonicNow();
 }
 
 
 void Bot::playerSpawnUpdate(int playerID, float x, float y, float z)
 {
-	players[playerID].isCreated = true;
-	players[playerID].isAlive = true;
-	players[playerID].x = x;
-	players[playerID].y = y;
-	players[playerID].z = z;
+	if (playerID == botID)
+	{
+		self.isAlive = true;
+		self.x = x;
+		self.y = y;
+		self.z = z;
+		return;
+	}
+	
+	// The player is no longer where the snapshot saw it
+	int32_t slot = world ? world->players.find(playerID) : -1;
+	
+	if (slot != -1) ignoreSlot(slot);
+	
+	Spawn spawn = { playerID, x, y, z };
+	int index = findSpawn(playerID);
+	
+	if (index == -1) spawns.push_back(spawn);
+	else spawns[index] = spawn;
 }
 
 
 void Bot::playerKilledUpdate(int playerID)
 {
-	players[playerID].isAlive = false;
+	if (playerID == botID)
+	{
+		self.isAlive = false;
+	}
+	else
+	{
+		int index = findSpawn(playerID);
+		
+		if (index != -1) spawns.erase(spawns.begin() + index);
+		
+		int32_t slot = world ? world->players.find(playerID) : -1;
+		
+		if (slot != -1) ignoreSlot(slot);
+	}
 
 	// if the player killed is this bot, reset the last action time
-	lastActionTime = clock();
+	lastActionTime = getTime();
 }
 
 
-void Bot::playerLocationUpdat(int playerID, float x, float y, float z)
+void Bot::setWorld(const shared_ptr<const WorldSnapshot>& snapshot)
 {
-	players[playerID].isAlive = true;
-	players[playerID].x = x;
-	players[playerID].y = y;
-	players[playerID].z = z;
+	world = snapshot;
+	
+	// The map update reflects the spawns and kills received before it
+	staleSlots.clear();
+	spawns.clear();
+	
+	int32_t slot = world->players.find(botID);
+	
+	if (slot == -1) return;
+	
+	// The bot itself is never a target
+	staleSlots.push_back(slot);
+	
+	if (world->players.isAlive(slot))
+	{
+		self.isAlive = true;
+		self.x = world->players.getX(slot);
+		self.y = world->players.getY(slot);
+		self.z = world->players.getZ(slot);
+	}
 }
 
 
@@ -87,31 +311,31 @@ void Bot::setKiller(int playerID)
 
 void Bot::incrementScore(int score)
 {
-	players[botID].score += score;
+	self.score += score;
 }
 
 
 float Bot::getX()
 {
-	return players[botID].x;
+	return self.x;
 }
 
 
 float Bot::getY()
 {
-	return players[botID].y;
+	return self.y;
 }
 
 
 float Bot::getZ()
 {
-	return players[botID].z;
+	return self.z;
 }
 
 
 int Bot::getScore()
 {
-	return players[botID].score;
+	return self.score;
 }
 
 
@@ -123,11 +347,23 @@ int Bot::getID()
 
 bool Bot::isAlive()
 {
-	return players[botID].isAlive;
+	return self.isAlive;
 }
 
 
 bool Bot::isCreated()
 {
-	return players[botID].isCreated;
+	return self.isCreated;
+}
+
+
+Player& Bot::getSelf()
+{
+	return self;
+}
+
+
+void Bot::setAlive(bool isAlive)
+{
+	self.isAlive = isAlive;
 }
@@ -4,9 +4,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <cmath>
 #include <ctime>
 #include <time.h>
+#include "SharedWorld.h"
+#include "Timing.h"
+#include "Random.h"
+#include "Log.h"
 
 
 // Bot action
@@ -17,7 +22,8 @@
 
 #define EXPLOSION_RADIUS 	0.4
 #define BOT_STEP			0.1
-#define ACTION_COOLDOWN		1
+#define ACTION_COOLDOWN		1	// seconds
+#define ACTION_COOLDOWN_NANOS	(ACTION_COOLDOWN * NANOS_PER_SECOND)
 
 using namespace std;
 
@@ -31,24 +37,54 @@ typedef struct
 	
 } Player;
 
+
+// Another player, at its position estimated by a bot at the time of its decision
+typedef struct
+{
+	int id;
+	float x, y, z;
+	
+} Target;
+
+
 class Bot
 {
 	private:
 		
+		static uint64_t masterSeed; // seed of the random generators of all bots
+		
+		// Player that spawned since the snapshot of the bot
+		struct Spawn
+		{
+			int id;
+			float x, y, z;
+		};
+		
+		shared_ptr<const WorldSnapshot> world; // latest map update received by the bot, shared with the other bots of the process
+		vector<int32_t> staleSlots; // slots of the snapshot to ignore: the bot itself, and the players killed or respawned since the snapshot
+		vector<Spawn> spawns; // players spawned since the snapshot
+		int64_t decisionTime; // time at which the positions of the other players are estimated
+		
+		// Ignore a slot of the snapshot until the next one
+		void ignoreSlot(int32_t slot);
 		
+		// Get the index of the player in the spawns since the snapshot, or -1 if it has not spawned since
+		int findSpawn(int playerID);
 	
 	public:
 	
 		int botID;
 		int killerID; // ID of the most recent killer of the bot
-		Player* players; // array to store info about players in the arena (including the bot itself)
-		int numPlayers;
-		float lastActionTime; // the last time the bot took some action (MOVE, EXPLODE, SPAWN)
+		Player self; // state of the bot itself
+		int64_t lastActionTime; // the last time the bot took some action (MOVE, EXPLODE, SPAWN), in monotonic nanoseconds
+		Random random; // random generator of the bot, seeded from the master seed and the bot ID
 	
 
-		Bot(int numPlayers, int ID);	
+		// Create a bot and assign an ID to it
+		// The bot knows nothing of the other players until it receives a map update
+		Bot(int ID);
 		
-		~Bot();
+		virtual ~Bot();
 		
 		// Tell the bot to perform the next action
 		// Return the code of the action performed by the bot
@@ -60,8 +96,9 @@ class Bot
 		// Update the bot of a player killed
 		void playerKilledUpdate(int playerID);
 		
-		// Update the bot of the location of a player
-		void playerLocationUpdat(int playerID, float x, float y, float z);
+		// Update the bot of the locations of all players, from a map update decoded by the shared world model
+		// Supersedes the spawns and kills received before the map update
+		void setWorld(const shared_ptr<const WorldSnapshot>& snapshot);
 		
 		// Increment the score of the bot
 		void incrementScore(int score); 
@@ -85,10 +122,48 @@ class Bot
 		
 		bool isCreated();
 		
+		// Get the player of the bot itself
+		Player& getSelf();
+		
+		// Set whether the bot itself is alive
+		void setAlive(bool isAlive);
+		
 		// Determine of action cool down is complete
 		bool coolDownDone();
 		
-		float getDistance(int32_t playerID1, int32_t playerID2);
+		// Get the monotonic time at which the action cool down is complete, in nanoseconds (see Timing.h)
+		// Return 0 if the bot can act right away
+		int64_t getNextActionTime();
+		
+		// Set the master seed of the random generators of the bots created afterwards
+		// Must be called before the bots are created, as the seed is shared by all threads
+		static void setMasterSeed(uint64_t seed);
+		
+		// Get the current time of the monotonic clock, in nanoseconds
+		// Unlike clock(), this clock keeps running while the process is idle
+		static int64_t getTime();
+		
+		// Get the distance between the bot and another player
+		float getDistance(const Target& target);
+		
+		// Set the time at which the positions of the other players are estimated to now
+		// Called by the bots before deciding on their action
+		void predictPositions();
+		
+		// Get the number of live players other than the bot within the radius of the point {x, y, z}
+		uint32_t countPlayersInRadius(float x, float y, float z, float radius);
+		
+		// Find any live player within explosion range of the bot
+		// Return false if there is none
+		bool findTarget(Target& target);
+		
+		// Find the live player nearest to the bot
+		// Return false if there is none
+		bool findNearest(Target& target);
+		
+		// Find the live player with the given ID
+		// Return false if the player is dead or unknown
+		bool findPlayer(int playerID, Target& target);
 };
 
 #endif
@@ -1,25 +1,21 @@
 #include "BotFactory.h"
 
-Bot* BotFactory::createBot(int botAIType, int numPlayers, int ID)
+int BotFactory::getTypeIndex(int botAIType)
 {
-	Bot* bot;
-	switch(botAIType)
-	{
-		case DUMB_BOT:
-		
-			bot = new DumbBot(numPlayers, ID);
-			break;
-		
-		case PUNISHER_BOT:
-		
-			bot = new PunisherBot(numPlayers, ID);
-			break;
-		
-		default:
-		
-			bot = new DumbBot(numPlayers, ID);
-			break;
-	}
+	int index = KnownBotTypes::indexOf(botAIType);
 	
-	return bot;
+	// Unknown types fall back to the dumb bot
+	return (index == -1) ? 0 : index;
+}
+
+
+Bot* BotFactory::createBot(int botAIType, int ID)
+{
+	return createBotOfType(getTypeIndex(botAIType), ID);
+}
+
+
+Bot* BotFactory::createBotOfType(int typeIndex, int ID)
+{
+	return KnownBotTypes::create(typeIndex, ID);
 }
@@ -4,16 +4,98 @@
 #include "Bot.h"
 #include "DumbBot.h"
 #include "PunisherBot.h"
+#include "MultiKillBot.h"
 
 //Bot AI type
 #define DUMB_BOT		10
 #define PUNISHER_BOT	11
+#define MULTI_KILL_BOT	12
+
+
+// A concrete bot class and the AI type code that selects it
+template <int CODE, typename BotClass>
+struct BotType
+{
+	static constexpr int TYPE_CODE = CODE;
+	typedef BotClass Class;
+};
+
+
+// Compile-time list of bot types
+// Each bot type is identified at runtime by its index in the list, and the operations on a bot are resolved on its concrete class,
+// so that they are direct calls the compiler can inline rather than virtual calls
+template <typename... Types>
+struct BotTypeList;
+
+template <>
+struct BotTypeList<>
+{
+	static constexpr int SIZE = 0;
+	
+	static inline int indexOf(int) { return -1; }
+	
+	static inline Bot* create(int, int) { return NULL; }
+	
+	static inline int performAction(int, Bot*) { return STANDBY; }
+};
+
+template <typename First, typename... Rest>
+struct BotTypeList<First, Rest...>
+{
+	static constexpr int SIZE = 1 + BotTypeList<Rest...>::SIZE;
+	
+	// Get the index of the type with the given AI type code, or -1 if there is none
+	static inline int indexOf(int code)
+	{
+		if (code == First::TYPE_CODE) return 0;
+		
+		int index = BotTypeList<Rest...>::indexOf(code);
+		
+		return (index == -1) ? -1 : index + 1;
+	}
+	
+	// Create a bot of the type at the given index
+	static inline Bot* create(int index, int ID)
+	{
+		if (index == 0) return new typename First::Class(ID);
+		
+		return BotTypeList<Rest...>::create(index - 1, ID);
+	}
+	
+	// Let a bot of the type at the given index perform its action
+	// The bot classes are final, so the call is bound to the concrete class at compile time
+	static inline int performAction(int index, Bot* bot)
+	{
+		if (index == 0) return static_cast<typename First::Class*>(bot)->performAction();
+		
+		return BotTypeList<Rest...>::performAction(index - 1, bot);
+	}
+};
+
+
+// The bot types known to the factory
+// The first type is the one created for unknown AI type codes
+typedef BotTypeList<BotType<DUMB_BOT, DumbBot>, BotType<PUNISHER_BOT, PunisherBot>, BotType<MULTI_KILL_BOT, MultiKillBot> > KnownBotTypes;
+
 
 class BotFactory
 {
 	public:
 		
-		static Bot* createBot(int botAIType, int numPlayers, int ID);
+		// Get the index of the bot type of an AI type code in KnownBotTypes
+		// Unknown codes get the index of the dumb bot
+		static int getTypeIndex(int botAIType);
+		
+		static Bot* createBot(int botAIType, int ID);
+		
+		// Create a bot of the type at the given index (see getTypeIndex)
+		static Bot* createBotOfType(int typeIndex, int ID);
+		
+		// Let a bot of the type at the given index perform its action, without a virtual call
+		static inline int performAction(int typeIndex, Bot* bot)
+		{
+			return KnownBotTypes::performAction(typeIndex, bot);
+		}
 };
 
 #endif
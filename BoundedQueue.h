@@ -0,0 +1,148 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ *
+ * Bounded lock-free queue with many producers and many consumers (MPMC), also used with a single consumer.
+ *
+ * The queue is a ring of cells, each with a sequence number that tells whose turn it is:
+ * a producer claims a cell by advancing the tail with a compare-and-swap, writes the item, then publishes it by bumping the sequence,
+ * and a consumer claims a published item by advancing the head the same way, takes it, then hands the cell back for the next lap.
+ * Threads on the same end never wait on each other beyond a failed compare-and-swap, and a consumer never waits on a producer
+ * that has claimed a cell but not published it yet: it simply sees the queue as empty until then.
+ *
+ * The queue never allocates after construction, so pushing fails when it is full.
+ * The users size it so that this cannot happen (see DecisionPool.h).
+ * The capacity is rounded up to a power of 2.
+ *
+ *********************************************************************************************************************************************/
+
+template <typename T>
+class BoundedQueue
+{
+	private:
+		
+		struct Cell
+		{
+			atomic<uint64_t> sequence; // position of the next item of the cell when free, that position + 1 once the item is published
+			T item;
+		};
+		
+		vector<Cell> cells;
+		uint64_t mask; // number of cells - 1
+		
+		atomic<uint64_t> tail; // position of the next item pushed
+		char padding[64]; // keeps the producers and the consumers on separate cache lines, so that they don't slow each other down
+		atomic<uint64_t> head; // position of the next item popped
+	
+	public:
+		
+		// Create a queue that holds at least capacity items
+		BoundedQueue(uint32_t capacity) : cells(roundCapacity(capacity))
+		{
+			mask = cells.size() - 1;
+			
+			for (size_t i = 0; i < cells.size(); i++)
+			{
+				cells[i].sequence.store(i, memory_order_relaxed);
+			}
+			
+			tail.store(0, memory_order_relaxed);
+			head.store(0, memory_order_relaxed);
+		}
+		
+		// Get the number of cells needed for the capacity
+		static uint32_t roundCapacity(uint32_t capacity)
+		{
+			uint32_t size = 2;
+			
+			while (size < capacity) size <<= 1;
+			
+			return size;
+		}
+		
+		// Add an item at the tail of the queue, from any thread
+		// Return false if the queue is full
+		bool push(const T& item)
+		{
+			uint64_t position = tail.load(memory_order_relaxed);
+			
+			while (true)
+			{
+				Cell& cell = cells[position & mask];
+				
+				int64_t lag = (int64_t)(cell.sequence.load(memory_order_acquire) - position);
+				
+				// The cell is free for this position, so claim it
+				if (lag == 0)
+				{
+					if (tail.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+				}
+				// The cell still holds the item of the previous lap
+				else if (lag < 0)
+				{
+					return false;
+				}
+				// Another producer claimed the position first
+				else
+				{
+					position = tail.load(memory_order_relaxed);
+				}
+			}
+			
+			Cell& cell = cells[position & mask];
+			
+			cell.item = item;
+			cell.sequence.store(position + 1, memory_order_release);
+			
+			return true;
+		}
+		
+		// Take the item at the head of the queue, from any thread
+		// Return false if the queue is empty
+		bool pop(T& item)
+		{
+			uint64_t position = head.load(memory_order_relaxed);
+			
+			while (true)
+			{
+				Cell& cell = cells[position & mask];
+				
+				int64_t lag = (int64_t)(cell.sequence.load(memory_order_acquire) - (position + 1));
+				
+				// The item is published, so claim it
+				if (lag == 0)
+				{
+					if (head.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+				}
+				// Not published yet
+				else if (lag < 0)
+				{
+					return false;
+				}
+				// Another consumer took the position first
+				else
+				{
+					position = head.load(memory_order_relaxed);
+				}
+			}
+			
+			Cell& cell = cells[position & mask];
+			
+			item = cell.item;
+			
+			// Free the cell for the next lap
+			cell.sequence.store(position + mask + 1, memory_order_release);
+			
+			return true;
+		}
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "BufferPool.h"
+
+#define NUM_SIZE_CLASSES	15	// number of powers of 2 from BUFFER_POOL_MIN_SIZE to BUFFER_POOL_MAX_SIZE
+
+static_assert((BUFFER_POOL_MIN_SIZE << (NUM_SIZE_CLASSES - 1)) == BUFFER_POOL_MAX_SIZE, "Wrong number of size classes");
+
+
+// A free buffer stores the pointer to the next free buffer of the same size in its first bytes
+static thread_local uint8_t* freeLists[NUM_SIZE_CLASSES];
+static thread_local uint32_t numFree[NUM_SIZE_CLASSES];
+static thread_local uint64_t numFreeBytes; // total size of the free buffers of the thread
+
+
+// Get the index of the smallest size class that holds size bytes
+static int getSizeClass(uint32_t size)
+{
+	int index = 0;
+	uint32_t classSize = BUFFER_POOL_MIN_SIZE;
+	
+	while (classSize < size)
+	{
+		classSize <<= 1;
+		index++;
+	}
+	
+	return index;
+}
+
+
+uint8_t* BufferPool::acquire(uint32_t minSize, uint32_t& capacity)
+{
+	// Buffers that are too large for the pool are allocated with their exact size
+	if (minSize > BUFFER_POOL_MAX_SIZE)
+	{
+		capacity = minSize;
+		return (uint8_t*)malloc(minSize);
+	}
+	
+	int index = getSizeClass(minSize);
+	
+	capacity = BUFFER_POOL_MIN_SIZE << index;
+	
+	// Reuse a free buffer if there is one
+	if (freeLists[index] != NULL)
+	{
+		uint8_t* buffer = freeLists[index];
+		freeLists[index] = *(uint8_t**)buffer;
+		numFree[index]--;
+		numFreeBytes -= capacity;
+		
+		return buffer;
+	}
+	
+	return (uint8_t*)malloc(capacity);
+}
+
+
+void BufferPool::release(uint8_t* buffer, uint32_t capacity)
+{
+	if (buffer == NULL) return;
+	
+	if (capacity > BUFFER_POOL_MAX_SIZE)
+	{
+		free(buffer);
+		return;
+	}
+	
+	int index = getSizeClass(capacity);
+	
+	// Don't keep more free buffers than needed
+	if (numFree[index] >= BUFFER_POOL_MAX_FREE || numFreeBytes + capacity > BUFFER_POOL_MAX_FREE_BYTES)
+	{
+		free(buffer);
+		return;
+	}
+	
+	*(uint8_t**)buffer = freeLists[index];
+	freeLists[index] = buffer;
+	numFree[index]++;
+	numFreeBytes += capacity;
+}
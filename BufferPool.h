@@ -0,0 +1,42 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BUFFER_POOL_MIN_SIZE		1024		// size of the smallest buffers (power of 2)
+#define BUFFER_POOL_MAX_SIZE		(1 << 24)	// size of the largest pooled buffers, larger buffers are allocated and freed directly
+#define BUFFER_POOL_MAX_FREE		64			// maximum number of free buffers kept for each size
+#define BUFFER_POOL_MAX_FREE_BYTES	BUFFER_POOL_MAX_SIZE	// maximum number of bytes of free buffers kept by each thread
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ * 
+ * Pool of receive buffers.
+ * 
+ * Buffer sizes are powers of 2, and the free buffers of each size are kept in a free list instead of being returned to the system.
+ * This way, a connection can grow its receive buffer to hold a large frame, and give it back once the frame is processed,
+ * without allocating memory in steady state.
+ * Each thread has its own free lists, so no locking is needed (each event loop only runs on one thread).
+ * The free buffers a thread keeps are capped in bytes as well as in number, so that a burst of large frames
+ * doesn't leave the thread holding gigabytes it will never use again.
+ * 
+ *********************************************************************************************************************************************/
+
+class BufferPool
+{
+	public:
+	
+		// Get a buffer of at least minSize bytes
+		// The actual size of the buffer is stored in capacity
+		// Return NULL if the memory can't be allocated
+		static uint8_t* acquire(uint32_t minSize, uint32_t& capacity);
+		
+		// Give back a buffer of the given capacity obtained from acquire()
+		static void release(uint8_t* buffer, uint32_t capacity);
+};
+
+#endif
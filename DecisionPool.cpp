@@ -0,0 +1,198 @@
+#include "DecisionPool.h"
+#include "PlayerClient.h"
+
+
+DecisionPool::DecisionPool(int numWorkers, uint32_t maxClients)
+{
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers.push_back(new Worker(maxClients));
+	}
+	
+	nextWorker = 0;
+	isRunning = false;
+}
+
+
+DecisionPool::~DecisionPool()
+{
+	stop();
+	
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		delete workers[i];
+	}
+}
+
+
+void DecisionPool::start(int firstCore)
+{
+	isRunning = true;
+	
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i]->runner = thread(runWorker, this, workers[i], (firstCore < 0) ? -1 : firstCore + (int)i);
+	}
+}
+
+
+void DecisionPool::stop()
+{
+	isRunning = false;
+	
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		if (!workers[i]->runner.joinable()) continue;
+		
+		workers[i]->notifier.notify();
+		workers[i]->runner.join();
+	}
+}
+
+
+DecisionPool::Worker* DecisionPool::claimIdleWorker()
+{
+	uint32_t start = nextWorker.load(memory_order_relaxed);
+	
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		Worker* worker = workers[(start + i) % workers.size()];
+		
+		bool isIdle = true;
+		
+		if (worker->isIdle.load(memory_order_relaxed) && worker->isIdle.compare_exchange_strong(isIdle, false)) return worker;
+	}
+	
+	return NULL;
+}
+
+
+bool DecisionPool::submit(PlayerClient* task)
+{
+	// An idle worker takes the task right away, otherwise the task waits in the inbox of a busy worker,
+	// until that worker takes it or a worker that runs out of tasks steals it
+	Worker* worker = claimIdleWorker();
+	bool isClaimed = (worker != NULL);
+	
+	if (!isClaimed) worker = workers[nextWorker.fetch_add(1, memory_order_relaxed) % workers.size()];
+	
+	if (!worker->inbox.push(task)) return false;
+	
+	worker->notifier.notify();
+	
+	// A worker may have gone idle since, after it last looked for tasks to steal
+	if (!isClaimed) wakeIdleWorker();
+	
+	return true;
+}
+
+
+void DecisionPool::wakeIdleWorker()
+{
+	Worker* worker = claimIdleWorker();
+	
+	if (worker != NULL) worker->notifier.notify();
+}
+
+
+PlayerClient* DecisionPool::steal(Worker* thief)
+{
+	// Start from a different victim each time, so that the thieves spread over the workers
+	uint32_t start = nextWorker.fetch_add(1, memory_order_relaxed);
+	
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		Worker* victim = workers[(start + i) % workers.size()];
+		
+		if (victim == thief) continue;
+		
+		PlayerClient* task = victim->tasks.steal();
+		
+		if (task != NULL) return task;
+		
+		// The victim may be busy with a task while more are waiting in its inbox
+		if (victim->inbox.pop(task)) return task;
+	}
+	
+	return NULL;
+}
+
+
+int DecisionPool::getNumWorkers()
+{
+	return workers.size();
+}
+
+
+void DecisionPool::runTask(PlayerClient* task)
+{
+	while (task != NULL)
+	{
+		// The client may be handed out again as soon as its decision is posted, which overwrites its link
+		PlayerClient* next = task->getNextDecision();
+		
+		task->decideBotAction();
+		
+		task = next;
+	}
+}
+
+
+void DecisionPool::runWorker(DecisionPool* pool, Worker* worker, int core)
+{
+	int numCores = (int)thread::hardware_concurrency();
+	
+	if (core >= 0 && numCores > 1)
+	{
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(core % numCores, &cpus);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	}
+	
+	while (true)
+	{
+		// Move the inbox to the deque, where the other workers can steal from it
+		PlayerClient* task;
+		uint32_t numMoved = 0;
+		
+		while (worker->inbox.pop(task))
+		{
+			// Only possible if the pool serves more clients than it was set up for
+			if (!worker->tasks.push(task)) runTask(task);
+			
+			numMoved++;
+		}
+		
+		// More tasks than this worker can run right away
+		if (numMoved > 1) pool->wakeIdleWorker();
+		
+		task = worker->tasks.pop();
+		
+		if (task == NULL) task = pool->steal(worker);
+		
+		if (task != NULL)
+		{
+			runTask(task);
+			continue;
+		}
+		
+		if (!pool->isRunning) break;
+		
+		// Sleep until a task is queued for this worker, or until a busy worker has tasks to steal
+		worker->isIdle = true;
+		
+		// Look again, since a busy worker may have queued spare tasks before it could see this one idle
+		task = pool->steal(worker);
+		
+		if (task != NULL)
+		{
+			worker->isIdle = false;
+			runTask(task);
+			continue;
+		}
+		
+		worker->notifier.consume();
+		worker->isIdle = false;
+	}
+}
@@ -0,0 +1,105 @@
+#ifndef DECISION_POOL_H
+#define DECISION_POOL_H
+
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <pthread.h>
+#include <sched.h>
+#include "BoundedQueue.h"
+#include "WorkStealingDeque.h"
+#include "Notifier.h"
+
+// Maximum number of clients whose decisions are handed to the pool as a single task
+// The bots due in the same tick of an event loop are batched, so that a tick costs a few queue operations rather than one per bot
+#define DECISION_BATCH_SIZE		8
+
+using namespace std;
+
+
+class PlayerClient;
+
+
+/********************************************************************************************************************************************
+ * 
+ * Pool of threads that take the decisions of the bots, away from the threads that do the network I/O.
+ * 
+ * In the default mode, each event loop lets its bots act on its own thread, so a slow decision delays
+ * the reception of the messages of every client of the loop, and the server's send buffers grow meanwhile.
+ * With a decision pool, an event loop hands the bots that are due to act to the workers instead, and keeps receiving.
+ * A worker runs the bots and posts each client back to its event loop, which sends the action (see EventLoop::postDecision),
+ * so a bot always sends through its own connection, on the thread that owns it.
+ * 
+ * The decisions are scheduled by work stealing, since their cost varies a lot from bot to bot and from tick to tick.
+ * A task is a batch of clients, linked through the clients themselves (see PlayerClient::getNextDecision), so no memory is allocated.
+ * The event loops queue their tasks on the bounded lock-free inbox of a worker, preferably an idle one.
+ * Each worker moves its inbox into its own work-stealing deque and works from its bottom, while idle workers steal from the top
+ * of the deques of the others, and from their inboxes, which take several consumers,
+ * so that a worker stuck on an expensive bot doesn't leave the tasks queued for it waiting.
+ * A worker with spare tasks wakes an idle worker to steal them, and workers sleep on an eventfd when there is nothing left to take.
+ * A client has at most one decision in flight, so queues sized for the number of clients never overflow.
+ * 
+ *********************************************************************************************************************************************/
+
+class DecisionPool
+{
+	private:
+	
+		// Decision thread with its queues of tasks
+		struct Worker
+		{
+			BoundedQueue<PlayerClient*> inbox; // tasks queued by the event loops
+			WorkStealingDeque<PlayerClient> tasks; // tasks taken from the inbox, which other workers may steal
+			Notifier notifier;
+			atomic<bool> isIdle; // set while the worker sleeps, until a thread claims it to wake it up
+			thread runner;
+			
+			Worker(uint32_t capacity) : inbox(capacity), tasks(capacity), notifier(true) { isIdle = false; }
+		};
+		
+		vector<Worker*> workers;
+		atomic<uint32_t> nextWorker; // worker of the next task when none is idle
+		atomic<bool> isRunning;
+		
+		// Take the tasks of a worker, and steal the tasks of the others, until the pool is stopped
+		// The worker is pinned to the given core, unless it is -1
+		static void runWorker(DecisionPool* pool, Worker* worker, int core);
+		
+		// Take a task queued for another worker, from its deque or from its inbox
+		// Return NULL if there is none
+		PlayerClient* steal(Worker* thief);
+		
+		// Wake up an idle worker, if any, so that it steals spare tasks
+		void wakeIdleWorker();
+		
+		// Claim an idle worker, so that no other thread wakes it up as well
+		// Return NULL if all workers are busy
+		Worker* claimIdleWorker();
+		
+		// Let the bots of the clients of a task decide
+		static void runTask(PlayerClient* task);
+		
+	public:
+	
+		// Create a pool of numWorkers threads, for up to maxClients clients
+		DecisionPool(int numWorkers, uint32_t maxClients);
+		
+		~DecisionPool();
+		
+		// Start the worker threads, pinned to consecutive cores from firstCore (not pinned if firstCore is -1)
+		void start(int firstCore);
+		
+		// Stop the worker threads once they have taken the decisions already requested
+		void stop();
+		
+		// Hand a task to the workers, from any thread
+		// The task is the first of a list of clients linked by PlayerClient::setNextDecision
+		// Return false if the task can't be queued
+		bool submit(PlayerClient* task);
+		
+		// Get the number of worker threads
+		int getNumWorkers();
+};
+
+#endif
@@ -1,52 +1,52 @@
 #include "DumbBot.h"
 
 
-DumbBot::DumbBot(int numPlayers, int ID) : Bot(numPlayers, ID)
+DumbBot::DumbBot(int ID) : Bot(ID)
 {
-	fprintf(stdout, "Dumb bot created\n");
+	LOG(LOG_LEVEL_INFO, "Dumb bot created\n");
 }
 
 
 int DumbBot::performAction()
 {
 	// Do nothing if the player has not been created
-	if (!players[botID].isCreated) return STANDBY;
+	if (!self.isCreated) return STANDBY;
 	
 	// If cooldown is not finished
 	if (!coolDownDone()) return STANDBY;
 	
 	// If the player is not alive
-	if (!players[botID].isAlive)
+	if (!self.isAlive)
 	{
 		// Generate a random spawn location
-		srand(time(NULL));
 		
-		players[botID].x = (rand() % 10)/(float)10;
-		players[botID].y = (rand() % 10)/(float)10;
-		players[botID].z = (rand() % 10)/(float)10;
+		self.x = random.nextBelow(10)/(float)10;
+		self.y = random.nextBelow(10)/(float)10;
+		self.z = random.nextBelow(10)/(float)10;
 		
-		players[botID].isAlive = true;
+		self.isAlive = true;
 		
 		// reset the last action time;
-		lastActionTime = clock();
+		lastActionTime = getTime();
 		
 		return SPAWN;
 	}
 	
+	// Decide on the estimated current positions of the other players
+	predictPositions();
+	
 	// Check if there's any alive player within explosion range
-	for (int i = 0; i < numPlayers; i++)
+	Target target;
+	
+	if (findTarget(target))
 	{
-		// If a live player that is not this bot is within explosion range
-		if (players[i].isAlive && i != botID && getDistance(botID, i) <= EXPLOSION_RADIUS)
-		{
-			fprintf(stdout, "Targeting player %d at {%.2f, %.2f, %.2f}\n", i, players[i].x, players[i].y, players[i].z);
-			fprintf(stdout, "Distance to target: %.2f\n", getDistance(botID, i));
-			
-			// Self-annihilate
-			players[botID].isAlive = false;
-			lastActionTime = clock();
-			return EXPLODE;
-		}
+		LOG(LOG_LEVEL_DEBUG, "Targeting player %d at {%.2f, %.2f, %.2f}\n", target.id, target.x, target.y, target.z);
+		LOG(LOG_LEVEL_DEBUG, "Distance to target: %.2f\n", getDistance(target));
+		
+		// Self-annihilate
+		self.isAlive = false;
+		lastActionTime = getTime();
+		return EXPLODE;
 	}
 	
 	// If no player is in range, move in 1 out of 6 directions
@@ -58,93 +58,92 @@ int DumbBot::performAction()
 	// 5: z negative
 	
 	// Generate a random direction
-	srand(time(NULL));
-	int dir = rand() % 6;
+	int dir = random.nextBelow(6);
 	
 	switch(dir)
 	{
 		case 0:
 		{
 			// if moving in the +x direction causes the bot to be out of range
-			if (players[botID].x + BOT_STEP > 1)
+			if (self.x + BOT_STEP > 1)
 			{
-				players[botID].x = 1;
+				self.x = 1;
 			}
 			else
 			{
-				players[botID].x += BOT_STEP;
+				self.x += BOT_STEP;
 			}
 			break;
 		}
 		case 1:
 		{
 			// if moving in the -x direction causes the bot to be out of range
-			if (players[botID].x - BOT_STEP < 0)
+			if (self.x - BOT_STEP < 0)
 			{
-				players[botID].x = 0;
+				self.x = 0;
 			}
 			else
 			{
-				players[botID].x -= BOT_STEP;
+				self.x -= BOT_STEP;
 			}
 			break;
 		}
 		case 2:
 		{
 			// if moving in the +y direction causes the bot to be out of range
-			if (players[botID].y + BOT_STEP > 1)
+			if (self.y + BOT_STEP > 1)
 			{
-				players[botID].y = 1;
+				self.y = 1;
 			}
 			else
 			{
-				players[botID].y += BOT_STEP;
+				self.y += BOT_STEP;
 			}
 			break;
 		}
 		case 3:
 		{
 			// if moving in the -y direction causes the bot to be out of range
-			if (players[botID].y - BOT_STEP < 0)
+			if (self.y - BOT_STEP < 0)
 			{
-				players[botID].y = 0;
+				self.y = 0;
 			}
 			else
 			{
-				players[botID].y -= BOT_STEP;
+				self.y -= BOT_STEP;
 			}
 			break;
 		}
 		case 4:
 		{
 			// if moving in the +z direction causes the bot to be out of range
-			if (players[botID].z + BOT_STEP > 1)
+			if (self.z + BOT_STEP > 1)
 			{
-				players[botID].z = 1;
+				self.z = 1;
 			}
 			else
 			{
-				players[botID].z += BOT_STEP;
+				self.z += BOT_STEP;
 			}
 			break;
 		}
 		case 5:
 		{
 			// if moving in the -z direction causes the bot to be out of range
-			if (players[botID].z - BOT_STEP < 0)
+			if (self.z - BOT_STEP < 0)
 			{
-				players[botID].z = 0;
+				self.z = 0;
 			}
 			else
 			{
-				players[botID].z -= BOT_STEP;
+				self.z -= BOT_STEP;
 			}
 			break;
 		}
 	}
 	
 	// reset the cooldown time
-	lastActionTime = clock();
+	lastActionTime = getTime();
 	
 	return MOVE;
 }
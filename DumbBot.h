@@ -3,7 +3,7 @@
 
 #include "Bot.h"
 
-class DumbBot: public Bot
+class DumbBot final: public Bot
 {
 	private:
 	
@@ -12,9 +12,8 @@ class DumbBot: public Bot
 	public:
 
 		// Create a dumb bot
-		// Inform the bot of the maximum number of players in the arena (including itself)
 		// Assign an ID to the bot
-		DumbBot(int numPlayers, int ID);
+		DumbBot(int ID);
 		
 		int performAction() override;
 };
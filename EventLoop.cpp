@@ -0,0 +1,282 @@
+#include "EventLoop.h"
+#include "PlayerClient.h"
+
+
+EventLoop::EventLoop() : stopNotifier(false)
+{
+	epollfd = epoll_create1(0);
+	
+	if (epollfd == -1)
+	{
+		LOG(LOG_LEVEL_ERROR, "Failed to create epoll instance: %s\n", strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	
+	numClients = 0;
+	
+	decisionPool = NULL;
+	decided = NULL;
+	decidedNotifier = NULL;
+	decidedSource.client = NULL;
+	decidedSource.type = DECISION_EVENT;
+	batch = NULL;
+	batchSize = 0;
+	decidedInline = NULL;
+	
+	isStopping = false;
+	stopSource.client = NULL;
+	stopSource.type = STOP_EVENT;
+	
+	watch(stopNotifier.getFD(), EPOLLIN, &stopSource);
+}
+
+
+EventLoop::~EventLoop()
+{
+	delete decided;
+	delete decidedNotifier;
+	close(epollfd);
+}
+
+
+int EventLoop::addClient(PlayerClient* client)
+{
+	if (client->start(this) == -1) return -1;
+	
+	numClients++;
+	
+	return 0;
+}
+
+
+int EventLoop::watch(int fd, uint32_t events, EventSource* source)
+{
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = events;
+	event.data.ptr = source;
+	
+	int res = epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &event);
+	
+	if (res == -1)
+	{
+		LOG(LOG_LEVEL_ERROR, "Failed to add file descriptor to epoll: %s\n", strerror(errno));
+	}
+	
+	return res;
+}
+
+
+int EventLoop::modify(int fd, uint32_t events, EventSource* source)
+{
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = events;
+	event.data.ptr = source;
+	
+	int res = epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &event);
+	
+	if (res == -1)
+	{
+		LOG(LOG_LEVEL_ERROR, "Failed to modify file descriptor in epoll: %s\n", strerror(errno));
+	}
+	
+	return res;
+}
+
+
+void EventLoop::unwatch(int fd)
+{
+	epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+
+void EventLoop::schedule(WheelTimer* timer, int64_t deadline)
+{
+	timers.schedule(timer, deadline);
+}
+
+
+void EventLoop::cancel(WheelTimer* timer)
+{
+	timers.cancel(timer);
+}
+
+
+int EventLoop::getTimeout()
+{
+	int64_t wakeup = timers.getNextWakeup();
+	
+	if (wakeup == -1) return -1;
+	
+	int64_t delay = wakeup - monotonicNow();
+	
+	if (delay <= 0) return 0;
+	
+	// Round up, so that the loop does not wake up before the timers are due
+	int64_t timeout = (delay + NANOS_PER_MILLISECOND - 1) / NANOS_PER_MILLISECOND;
+	
+	return (timeout > INT_MAX) ? INT_MAX : (int)timeout;
+}
+
+
+void EventLoop::runExpiredTimers()
+{
+	WheelTimer* timer = timers.advance(monotonicNow());
+	
+	while (timer != NULL)
+	{
+		// The client may schedule the timer again, which overwrites its next pointer
+		WheelTimer* next = timer->next;
+		
+		timer->next = NULL;
+		timer->source->client->handleEvent(timer->source->type, 0);
+		
+		timer = next;
+	}
+}
+
+
+void EventLoop::setDecisionPool(DecisionPool* pool, uint32_t maxClients)
+{
+	decisionPool = pool;
+	
+	// Each client has at most one decision in flight, so the queue never overflows
+	decided = new BoundedQueue<PlayerClient*>(maxClients);
+	decidedNotifier = new Notifier(false);
+	
+	watch(decidedNotifier->getFD(), EPOLLIN, &decidedSource);
+}
+
+
+bool EventLoop::hasDecisionPool()
+{
+	return decisionPool != NULL;
+}
+
+
+void EventLoop::submitDecision(PlayerClient* client)
+{
+	client->setNextDecision(batch);
+	batch = client;
+	
+	if (++batchSize == DECISION_BATCH_SIZE) flushDecisions();
+}
+
+
+void EventLoop::flushDecisions()
+{
+	if (batch == NULL) return;
+	
+	// Only possible if the pool serves more clients than it was set up for
+	// The bots then decide on this thread, and their actions are completed at the end of the iteration,
+	// rather than through the decided queue, which only this thread drains
+	if (!decisionPool->submit(batch))
+	{
+		while (batch != NULL)
+		{
+			PlayerClient* next = batch->getNextDecision();
+			
+			batch->takeBotDecision();
+			batch->setNextDecision(decidedInline);
+			decidedInline = batch;
+			batch = next;
+		}
+	}
+	
+	batch = NULL;
+	batchSize = 0;
+}
+
+
+void EventLoop::postDecision(PlayerClient* client)
+{
+	// Only possible if the loop serves more clients than it was set up for
+	// Only the workers of the pool post decisions, so the thread of the loop keeps draining the queue meanwhile
+	while (!decided->push(client)) sched_yield();
+	
+	decidedNotifier->notify();
+}
+
+
+void EventLoop::runDecidedActions()
+{
+	// Consume the notification first, so that a decision posted while the queue is drained wakes up the loop again
+	decidedNotifier->consume();
+	
+	PlayerClient* client;
+	
+	while (decided->pop(client))
+	{
+		client->handleEvent(DECISION_EVENT, 0);
+	}
+}
+
+
+void EventLoop::runInlineActions()
+{
+	while (decidedInline != NULL)
+	{
+		PlayerClient* client = decidedInline;
+		
+		decidedInline = client->getNextDecision();
+		client->handleEvent(DECISION_EVENT, 0);
+	}
+}
+
+
+void EventLoop::clientClosed()
+{
+	numClients--;
+}
+
+
+Metrics& EventLoop::getMetrics()
+{
+	return metrics;
+}
+
+
+void EventLoop::stop()
+{
+	isStopping = true;
+	stopNotifier.notify();
+}
+
+
+void EventLoop::run()
+{
+	struct epoll_event events[MAX_EPOLL_EVENTS];
+	
+	while (numClients > 0 && !isStopping)
+	{
+		// Sleep until a socket is ready or the next bot is due
+		int count = epoll_wait(epollfd, events, MAX_EPOLL_EVENTS, getTimeout());
+		
+		// If there's an error
+		if (count == -1)
+		{
+			if (errno != EINTR)
+			{
+				LOG(LOG_LEVEL_ERROR, "Error waiting for socket activity: %s\n", strerror(errno));
+			}
+			continue;
+		}
+		
+		for (int i = 0; i < count; i++)
+		{
+			EventSource* source = (EventSource*)events[i].data.ptr;
+			
+			if (source->type == DECISION_EVENT) runDecidedActions();
+			else if (source->type == STOP_EVENT) stopNotifier.consume();
+			else source->client->handleEvent(source->type, events[i].events);
+		}
+		
+		// Only the bots whose cooldown is over are run
+		runExpiredTimers();
+		
+		// The bots that are due to act in this iteration are handed to the decision pool together
+		flushDecisions();
+		runInlineActions();
+	}
+}
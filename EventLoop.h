@@ -0,0 +1,138 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <sys/epoll.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sched.h>
+#include <atomic>
+#include "TimingWheel.h"
+#include "BoundedQueue.h"
+#include "Notifier.h"
+#include "DecisionPool.h"
+#include "Metrics.h"
+#include "Log.h"
+
+// Event source types
+#define SOCKET_EVENT		1
+#define TIMER_EVENT			2
+#define DECISION_EVENT		3	// the decision of a bot taken by a worker of the decision pool is back
+#define STOP_EVENT			4	// the loop is asked to stop, from another thread
+
+#define MAX_EPOLL_EVENTS	256
+
+using namespace std;
+
+
+class PlayerClient;
+
+// Identify which file descriptor (or timer) of which client an event belongs to
+typedef struct EventSource
+{
+	PlayerClient* client;
+	int type;
+	
+} EventSource;
+
+
+class EventLoop
+{
+	private:
+	
+		int epollfd;
+		int numClients; // number of clients whose connection is still open
+		TimingWheel timers; // action timers of the bots of the clients
+		
+		// Decisions of the bots taken on the threads of a decision pool, if any (see DecisionPool.h)
+		DecisionPool* decisionPool; // NULL if the bots act on the thread of the loop
+		BoundedQueue<PlayerClient*>* decided; // clients whose decision is back from the pool, posted by the workers
+		Notifier* decidedNotifier; // wakes up the loop when decisions are posted
+		EventSource decidedSource;
+		PlayerClient* batch; // clients due to decide in the current iteration of the loop, not handed to the pool yet
+		uint32_t batchSize;
+		PlayerClient* decidedInline; // clients that decided on the thread of the loop because the pool was full, linked like a batch
+		
+		Metrics metrics; // latencies and message counts of the clients of this loop
+		
+		atomic<bool> isStopping; // set by stop(), from any thread
+		Notifier stopNotifier; // wakes up the loop when it is asked to stop
+		EventSource stopSource;
+		
+		// Get the epoll timeout until the timing wheel next needs to be advanced, in milliseconds
+		// Return -1 if no timer is scheduled
+		int getTimeout();
+		
+		// Hand the expired timers to their clients
+		void runExpiredTimers();
+		
+		// Hand the decisions posted by the decision pool to their clients
+		void runDecidedActions();
+		
+		// Hand the batch of clients due to decide to the decision pool
+		void flushDecisions();
+		
+		// Hand the decisions taken on the thread of the loop to their clients
+		void runInlineActions();
+		
+	public:
+	
+		// Create an event loop with its own epoll instance
+		EventLoop();
+		
+		~EventLoop();
+		
+		// Start the client and hand its events to this loop
+		// Return 0 on success, -1 on failure
+		int addClient(PlayerClient* client);
+		
+		// Watch the file descriptor for the epoll events
+		// Return 0 on success, -1 on failure
+		int watch(int fd, uint32_t events, EventSource* source);
+		
+		// Change the epoll events watched on the file descriptor
+		// Return 0 on success, -1 on failure
+		int modify(int fd, uint32_t events, EventSource* source);
+		
+		// Stop watching the file descriptor
+		void unwatch(int fd);
+		
+		// Schedule a timer to expire at the given monotonic time, in nanoseconds
+		// Its client then receives a TIMER_EVENT
+		void schedule(WheelTimer* timer, int64_t deadline);
+		
+		// Cancel a timer if it is scheduled
+		void cancel(WheelTimer* timer);
+		
+		// Let the bots of the clients of this loop decide on the threads of the pool, for up to maxClients clients
+		// Must be called before the loop runs
+		void setDecisionPool(DecisionPool* pool, uint32_t maxClients);
+		
+		// Determine if the bots of the clients decide on the threads of a decision pool
+		bool hasDecisionPool();
+		
+		// Ask the decision pool to take the decision of the bot of the client
+		// The clients due in the same iteration of the loop are handed to the pool in batches of up to DECISION_BATCH_SIZE
+		void submitDecision(PlayerClient* client);
+		
+		// Post the client whose decision is taken back to the loop, from a thread of the decision pool
+		// The client then receives a DECISION_EVENT on the thread of the loop
+		void postDecision(PlayerClient* client);
+		
+		// Inform the loop that one of its clients has closed its connection
+		void clientClosed();
+		
+		// Get the metrics of the clients of this loop, only written from the thread of the loop
+		Metrics& getMetrics();
+		
+		// Make run() return after the current iteration, even though connections are still open, from any thread
+		void stop();
+		
+		// Dispatch events to the clients until all their connections are closed or the loop is stopped
+		void run();
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "LatencyHistogram.h"
+
+
+LatencyHistogram::LatencyHistogram()
+{
+	for (uint32_t i = 0; i < LATENCY_NUM_BUCKETS; i++)
+	{
+		counts[i].store(0, memory_order_relaxed);
+	}
+	
+	count.store(0, memory_order_relaxed);
+	sum.store(0, memory_order_relaxed);
+	max.store(0, memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::getBucketLimit(uint32_t bucket)
+{
+	if (bucket < LATENCY_SUB_BUCKETS) return bucket;
+	
+	// Inverse of getBucket()
+	uint32_t shift = bucket / LATENCY_SUB_BUCKETS - 1;
+	uint64_t leading = bucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS;
+	
+	return ((leading + 1) << shift) - 1;
+}
+
+
+void LatencyHistogram::add(const LatencyHistogram& other)
+{
+	for (uint32_t i = 0; i < LATENCY_NUM_BUCKETS; i++)
+	{
+		increase(counts[i], other.counts[i].load(memory_order_relaxed));
+	}
+	
+	// The total is taken from the buckets rather than from the other count, so that percentiles stay consistent
+	// if the other histogram is written meanwhile
+	uint64_t total = 0;
+	
+	for (uint32_t i = 0; i < LATENCY_NUM_BUCKETS; i++)
+	{
+		total += counts[i].load(memory_order_relaxed);
+	}
+	
+	count.store(total, memory_order_relaxed);
+	increase(sum, other.sum.load(memory_order_relaxed));
+	
+	uint64_t otherMax = other.max.load(memory_order_relaxed);
+	
+	if (otherMax > max.load(memory_order_relaxed)) max.store(otherMax, memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::getCount() const
+{
+	return count.load(memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::getMax() const
+{
+	return max.load(memory_order_relaxed);
+}
+
+
+double LatencyHistogram::getMean() const
+{
+	uint64_t n = count.load(memory_order_relaxed);
+	
+	if (n == 0) return 0;
+	
+	return sum.load(memory_order_relaxed) / (double)n;
+}
+
+
+uint64_t LatencyHistogram::getPercentile(double percent) const
+{
+	uint64_t n = count.load(memory_order_relaxed);
+	
+	if (n == 0) return 0;
+	
+	// Rank of the value, counted from 1
+	uint64_t rank = (uint64_t)(percent / 100 * n + 0.5);
+	
+	if (rank < 1) rank = 1;
+	if (rank > n) rank = n;
+	
+	uint64_t seen = 0;
+	
+	for (uint32_t i = 0; i < LATENCY_NUM_BUCKETS; i++)
+	{
+		seen += counts[i].load(memory_order_relaxed);
+		
+		if (seen >= rank)
+		{
+			// The bucket limit may exceed any value actually recorded
+			uint64_t limit = getBucketLimit(i);
+			uint64_t largest = max.load(memory_order_relaxed);
+			
+			return (limit < largest) ? limit : largest;
+		}
+	}
+	
+	return max.load(memory_order_relaxed);
+}
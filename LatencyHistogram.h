@@ -0,0 +1,98 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Each power of 2 of latencies is split into 2^LATENCY_SUB_BUCKET_BITS buckets, so a value is known within about 3%
+#define LATENCY_SUB_BUCKET_BITS		5
+#define LATENCY_SUB_BUCKETS			(1 << LATENCY_SUB_BUCKET_BITS)
+
+// Latencies of 2^(LATENCY_MAX_EXPONENT + 1) nanoseconds (about 36 minutes) or more are counted in the last bucket
+#define LATENCY_MAX_EXPONENT		40
+#define LATENCY_NUM_BUCKETS			((LATENCY_MAX_EXPONENT - LATENCY_SUB_BUCKET_BITS + 2) * LATENCY_SUB_BUCKETS)
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ *
+ * Histogram of latencies in nanoseconds, with buckets on a log-linear scale like an HDR histogram.
+ *
+ * The values below 2^LATENCY_SUB_BUCKET_BITS have a bucket each, and every power of 2 above has the same number of buckets,
+ * so the relative precision is the same from nanoseconds to minutes and the tail percentiles keep their resolution.
+ * Recording a value is a few shifts and an increment, with no allocation and no search.
+ *
+ * A histogram has a single writer, the thread that owns it, so the counters are only written with relaxed loads and stores,
+ * which cost no more than plain accesses.
+ * Other threads can read it at any time, for example to merge the histograms of several threads in a report,
+ * and see each counter either before or after a concurrent update.
+ *
+ *********************************************************************************************************************************************/
+
+class LatencyHistogram
+{
+	private:
+		
+		atomic<uint64_t> counts[LATENCY_NUM_BUCKETS];
+		atomic<uint64_t> count; // number of values recorded
+		atomic<uint64_t> sum; // sum of the values, for the mean
+		atomic<uint64_t> max; // largest value
+		
+		// Add to a counter that only the owner thread writes
+		static inline void increase(atomic<uint64_t>& counter, uint64_t value)
+		{
+			counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed);
+		}
+		
+		// Get the bucket of a value
+		static inline uint32_t getBucket(uint64_t value)
+		{
+			if (value < LATENCY_SUB_BUCKETS) return (uint32_t)value;
+			
+			int exponent = 63 - __builtin_clzll(value);
+			
+			if (exponent > LATENCY_MAX_EXPONENT) return LATENCY_NUM_BUCKETS - 1;
+			
+			// The leading bits below the highest one select the bucket within the power of 2
+			uint32_t shift = exponent - LATENCY_SUB_BUCKET_BITS;
+			
+			return (shift + 1) * LATENCY_SUB_BUCKETS + (uint32_t)(value >> shift) - LATENCY_SUB_BUCKETS;
+		}
+		
+		// Get the largest value that falls in a bucket
+		static uint64_t getBucketLimit(uint32_t bucket);
+	
+	public:
+		
+		LatencyHistogram();
+		
+		// Record a latency, only from the owner thread
+		// Negative latencies, which a clock can't produce, are counted as 0
+		inline void record(int64_t nanos)
+		{
+			uint64_t value = (nanos > 0) ? (uint64_t)nanos : 0;
+			
+			increase(counts[getBucket(value)], 1);
+			increase(count, 1);
+			increase(sum, value);
+			
+			if (value > max.load(memory_order_relaxed)) max.store(value, memory_order_relaxed);
+		}
+		
+		// Add the values of another histogram to this one, which must not be written by another thread meanwhile
+		void add(const LatencyHistogram& other);
+		
+		uint64_t getCount() const;
+		
+		uint64_t getMax() const;
+		
+		// Get the mean latency, or 0 if there is no value
+		double getMean() const;
+		
+		// Get the latency that the given percentage of the values don't exceed, within the precision of the buckets
+		// Return 0 if there is no value
+		uint64_t getPercentile(double percent) const;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "Log.h"
+
+
+atomic<int> Log::level(LOG_LEVEL_INFO);
+int64_t Log::startTime = monotonicNow();
+
+mutex Log::ringsLock;
+vector<Log::Ring*> Log::rings;
+thread_local Log::Ring* Log::ring = NULL;
+
+thread Log::drainer;
+atomic<bool> Log::isRunning(false);
+
+
+void Log::setLevel(int newLevel)
+{
+	level.store(newLevel, memory_order_relaxed);
+}
+
+
+Log::Ring* Log::getRing()
+{
+	if (ring != NULL) return ring;
+	
+	ring = new Ring();
+	ring->tail.store(0, memory_order_relaxed);
+	ring->head.store(0, memory_order_relaxed);
+	ring->numDropped.store(0, memory_order_relaxed);
+	
+	lock_guard<mutex> guard(ringsLock);
+	rings.push_back(ring);
+	
+	return ring;
+}
+
+
+LogRecord* Log::reserve()
+{
+	Ring* r = getRing();
+	
+	uint64_t tail = r->tail.load(memory_order_relaxed);
+	
+	// Full: the drain thread hasn't caught up with this thread
+	if (tail - r->head.load(memory_order_acquire) == LOG_RING_SIZE)
+	{
+		r->numDropped.fetch_add(1, memory_order_relaxed);
+		return NULL;
+	}
+	
+	return &r->records[tail & (LOG_RING_SIZE - 1)];
+}
+
+
+void Log::commit()
+{
+	// Publish the record filled since reserve()
+	ring->tail.store(ring->tail.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+
+void Log::print(const LogRecord& record)
+{
+	static const char* levelNames[] = { "ERROR", "WARNING", "INFO", "DEBUG" };
+	
+	FILE* out = (record.level <= LOG_LEVEL_WARNING) ? stderr : stdout;
+	
+	fprintf(out, "[%.6f] %s: ", nanosToSeconds(record.time - startTime), levelNames[record.level]);
+	record.formatter(out, record.format, record.args, record.args + sizeof(record.args));
+}
+
+
+void Log::drain()
+{
+	vector<Ring*> snapshot;
+	
+	{
+		lock_guard<mutex> guard(ringsLock);
+		snapshot = rings;
+	}
+	
+	// Only the records published when the pass starts, so that busy threads can't keep the drain thread from reporting
+	vector<uint64_t> tails(snapshot.size());
+	
+	for (size_t i = 0; i < snapshot.size(); i++)
+	{
+		tails[i] = snapshot[i]->tail.load(memory_order_acquire);
+	}
+	
+	// Merge the rings by time, since the records of each ring are already in order
+	while (true)
+	{
+		Ring* earliest = NULL;
+		int64_t earliestTime = 0;
+		
+		for (size_t i = 0; i < snapshot.size(); i++)
+		{
+			uint64_t head = snapshot[i]->head.load(memory_order_relaxed);
+			
+			if (head == tails[i]) continue;
+			
+			int64_t time = snapshot[i]->records[head & (LOG_RING_SIZE - 1)].time;
+			
+			if (earliest == NULL || time < earliestTime)
+			{
+				earliest = snapshot[i];
+				earliestTime = time;
+			}
+		}
+		
+		if (earliest == NULL) break;
+		
+		uint64_t head = earliest->head.load(memory_order_relaxed);
+		
+		print(earliest->records[head & (LOG_RING_SIZE - 1)]);
+		
+		// Hand the record back to its thread
+		earliest->head.store(head + 1, memory_order_release);
+	}
+	
+	uint64_t numDropped = 0;
+	
+	for (size_t i = 0; i < snapshot.size(); i++)
+	{
+		numDropped += snapshot[i]->numDropped.exchange(0, memory_order_relaxed);
+	}
+	
+	if (numDropped > 0)
+	{
+		fprintf(stderr, "[%.6f] WARNING: %llu log records dropped\n", nanosToSeconds(monotonicNow() - startTime), (unsigned long long)numDropped);
+	}
+	
+	fflush(stdout);
+	fflush(stderr);
+}
+
+
+void Log::runDrainer()
+{
+	while (isRunning.load(memory_order_acquire))
+	{
+		drain();
+		
+		this_thread::sleep_for(chrono::nanoseconds(LOG_DRAIN_INTERVAL_NANOS));
+	}
+}
+
+
+void Log::start()
+{
+	if (isRunning.exchange(true)) return;
+	
+	drainer = thread(runDrainer);
+	
+	// Also write out the records logged before the process exits from elsewhere than the end of main()
+	static bool isRegistered = false;
+	
+	if (!isRegistered)
+	{
+		atexit(stop);
+		isRegistered = true;
+	}
+}
+
+
+void Log::stop()
+{
+	if (isRunning.exchange(false)) drainer.join();
+	
+	drain();
+}
@@ -0,0 +1,266 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Timing.h"
+
+// Levels of the log records, from the most to the least important
+// Records of a level above the current one are discarded at the call site
+#define LOG_LEVEL_ERROR		0
+#define LOG_LEVEL_WARNING	1
+#define LOG_LEVEL_INFO		2
+#define LOG_LEVEL_DEBUG		3
+
+// Size of a record, which holds the arguments of the call, strings included
+#define LOG_RECORD_SIZE		128
+
+// Number of records in the ring of each thread (power of 2)
+// Records logged while the ring is full are dropped and counted
+#define LOG_RING_SIZE		4096
+
+// Time between two passes of the drain thread
+#define LOG_DRAIN_INTERVAL_NANOS	(10 * NANOS_PER_MILLISECOND)
+
+// Log a record, printf-style, if its level is enabled
+// When it is not, the call costs a load and a branch, and the arguments are not even evaluated
+// The branch is laid out for disabled records, since the per-action debug records are off by default
+#define LOG(level, ...) \
+	do \
+	{ \
+		if (__builtin_expect((level) <= Log::getLevel(), 0)) Log::write((level), __VA_ARGS__); \
+		if (0) Log::checkFormat(__VA_ARGS__); \
+	} while (0)
+
+using namespace std;
+
+
+// Formats the arguments packed in a record with the format string of its call site
+typedef void (*LogFormatter)(FILE* out, const char* format, const uint8_t* args, const uint8_t* end);
+
+struct LogRecord
+{
+	int64_t time; // when the record was logged, on the monotonic clock
+	const char* format; // format string of the call site, a literal that lives as long as the program
+	LogFormatter formatter; // unpacks the arguments with the types of the call site
+	int32_t level;
+	uint8_t args[LOG_RECORD_SIZE - 2 * sizeof(int64_t) - sizeof(LogFormatter) - sizeof(int32_t)]; // arguments, packed back to back
+};
+
+
+/********************************************************************************************************************************************
+ *
+ * Packing of the arguments of a log call into a record, and unpacking for the drain thread.
+ *
+ * Numbers and pointers are copied as they are, so a call site only copies a few bytes and the formatting happens later.
+ * Strings are copied into the record, truncated to the space left, since the caller's buffer may be gone by the time
+ * the record is formatted.
+ * Loading checks the space left exactly like storing did, so an argument that didn't fit reads as 0 or an empty string.
+ *
+ *********************************************************************************************************************************************/
+
+template <typename T>
+struct LogArg
+{
+	typedef T Stored;
+	
+	static inline void store(uint8_t*& p, uint8_t* end, T value)
+	{
+		// The argument doesn't fit after the strings before it
+		if (p + sizeof(T) > end) return;
+		
+		memcpy(p, &value, sizeof(T));
+		p += sizeof(T);
+	}
+	
+	static inline T load(const uint8_t*& p, const uint8_t* end)
+	{
+		T value = T();
+		
+		if (p + sizeof(T) > end) return value;
+		
+		memcpy(&value, p, sizeof(T));
+		p += sizeof(T);
+		
+		return value;
+	}
+};
+
+
+template <>
+struct LogArg<const char*>
+{
+	typedef const char* Stored;
+	
+	static inline void store(uint8_t*& p, uint8_t* end, const char* value)
+	{
+		if (p >= end) return;
+		
+		size_t length = strnlen(value, end - p - 1);
+		
+		memcpy(p, value, length);
+		p[length] = 0;
+		p += length + 1;
+	}
+	
+	static inline const char* load(const uint8_t*& p, const uint8_t* end)
+	{
+		if (p >= end) return "";
+		
+		const char* value = (const char*)p;
+		p += strlen(value) + 1;
+		
+		return value;
+	}
+};
+
+
+template <>
+struct LogArg<char*> : LogArg<const char*>
+{
+};
+
+
+// Unpacks the arguments of a record one type at a time, then formats them all at once
+template <typename... Rest>
+struct LogUnpacker;
+
+template <>
+struct LogUnpacker<>
+{
+	template <typename... Loaded>
+	static void print(FILE* out, const char* format, const uint8_t* p, const uint8_t* end, Loaded... loaded)
+	{
+		// The trailing argument keeps the call valid when the format has no conversion, and is ignored otherwise
+		fprintf(out, format, loaded..., 0);
+	}
+};
+
+template <typename First, typename... Rest>
+struct LogUnpacker<First, Rest...>
+{
+	template <typename... Loaded>
+	static void print(FILE* out, const char* format, const uint8_t* p, const uint8_t* end, Loaded... loaded)
+	{
+		typename LogArg<First>::Stored value = LogArg<First>::load(p, end);
+		
+		LogUnpacker<Rest...>::print(out, format, p, end, loaded..., value);
+	}
+};
+
+
+/********************************************************************************************************************************************
+ *
+ * Asynchronous logging, so that the threads of the swarm never wait on stdio.
+ *
+ * Formatting and writing a line on every move, spawn or kill takes the stdio lock and costs more than the action itself
+ * when thousands of bots act.
+ * Instead, a call site copies its arguments into a fixed-size binary record, in a lock-free ring owned by the calling thread,
+ * and a background thread drains the rings, merges the records by time, and formats them on stdout (info and debug)
+ * or stderr (errors and warnings).
+ * Each ring has a single producer and a single consumer, so logging costs two atomic accesses without contention.
+ * If the drain thread falls behind, the records that don't fit are dropped rather than blocking the caller, and the drops are reported.
+ *
+ * The format strings must be literals, since the records only keep a pointer to them.
+ * Records logged before start() wait in the rings, and stop() writes out everything that was logged.
+ *
+ *********************************************************************************************************************************************/
+
+class Log
+{
+	private:
+		
+		struct Ring
+		{
+			LogRecord records[LOG_RING_SIZE];
+			atomic<uint64_t> tail; // position of the next record logged, only written by the owner thread
+			char padding[64]; // keeps the owner and the drain thread on separate cache lines
+			atomic<uint64_t> head; // position of the next record drained, only written by the drain thread
+			atomic<uint64_t> numDropped; // records dropped since the last report
+		};
+		
+		static atomic<int> level;
+		static int64_t startTime;
+		
+		// The rings of all the threads that logged, kept until the program ends, since records may outlive their thread
+		static mutex ringsLock;
+		static vector<Ring*> rings;
+		static thread_local Ring* ring;
+		
+		static thread drainer;
+		static atomic<bool> isRunning;
+		
+		// Get the ring of the calling thread, created on its first record
+		static Ring* getRing();
+		
+		// Reserve the next record of the calling thread's ring, or return NULL if it is full
+		static LogRecord* reserve();
+		
+		// Publish the record returned by reserve()
+		static void commit();
+		
+		// Write out the records of all the rings, in time order
+		static void drain();
+		
+		// Write out a single record
+		static void print(const LogRecord& record);
+		
+		static void runDrainer();
+	
+	public:
+		
+		// Get the highest level that is logged
+		static inline int getLevel()
+		{
+			return level.load(memory_order_relaxed);
+		}
+		
+		// Set the highest level that is logged
+		static void setLevel(int newLevel);
+		
+		// Start the drain thread
+		static void start();
+		
+		// Write out the pending records and stop the drain thread
+		// Also called at exit, so that the records logged before a fatal error are not lost
+		static void stop();
+		
+		// Log a record, without checking its level (see LOG)
+		template <typename... Args>
+		static void write(int recordLevel, const char* format, Args... args)
+		{
+			LogRecord* record = reserve();
+			
+			if (record == NULL) return;
+			
+			record->time = monotonicNow();
+			record->format = format;
+			record->formatter = &LogUnpacker<Args...>::print;
+			record->level = recordLevel;
+			
+			uint8_t* p = record->args;
+			uint8_t* end = record->args + sizeof(record->args);
+			
+			// The braced list stores the arguments in order, and the casts keep calls without arguments from warning
+			int order[] = { 0, (LogArg<Args>::store(p, end, args), 0)... };
+			(void)order;
+			(void)p;
+			(void)end;
+			
+			commit();
+		}
+		
+		// Never called: lets the compiler check the format string of a LOG call against its arguments
+		__attribute__((format(printf, 1, 2))) static void checkFormat(const char* format, ...)
+		{
+		}
+};
+
+#endif
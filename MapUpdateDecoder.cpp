@@ -0,0 +1,145 @@
+#include "MapUpdateDecoder.h"
+
+
+// The SIMD paths load each record as 4 floats
+static_assert(ServerMapUpdateMessage::RECORD_SIZE == 16, "Map update records must be 16 bytes");
+
+typedef void (*DecodeFunction)(const uint8_t* records, uint32_t numRecords, int32_t* ids, float* xs, float* ys, float* zs);
+
+
+static void decodeScalar(const uint8_t* records, uint32_t numRecords, int32_t* ids, float* xs, float* ys, float* zs)
+{
+	for (uint32_t i = 0; i < numRecords; i++)
+	{
+		ServerMapUpdateMessage::RecordLayout::decode(records + i * 16, ids[i], xs[i], ys[i], zs[i]);
+	}
+}
+
+
+#if SIMD_X86
+
+__attribute__((target("sse2")))
+static void decodeSSE(const uint8_t* records, uint32_t numRecords, int32_t* ids, float* xs, float* ys, float* zs)
+{
+	uint32_t i = 0;
+	
+	// Transpose 4 records at a time
+	// Each record is loaded as 4 floats, with the bits of the ID in the first float
+	for (; i + 4 <= numRecords; i += 4)
+	{
+		const float* src = (const float*)(records + i * 16);
+		
+		__m128 r0 = _mm_loadu_ps(src);
+		__m128 r1 = _mm_loadu_ps(src + 4);
+		__m128 r2 = _mm_loadu_ps(src + 8);
+		__m128 r3 = _mm_loadu_ps(src + 12);
+		
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		
+		_mm_storeu_si128((__m128i*)(ids + i), _mm_castps_si128(r0));
+		_mm_storeu_ps(xs + i, r1);
+		_mm_storeu_ps(ys + i, r2);
+		_mm_storeu_ps(zs + i, r3);
+	}
+	
+	decodeScalar(records + i * 16, numRecords - i, ids + i, xs + i, ys + i, zs + i);
+}
+
+
+__attribute__((target("avx")))
+static void decodeAVX(const uint8_t* records, uint32_t numRecords, int32_t* ids, float* xs, float* ys, float* zs)
+{
+	uint32_t i = 0;
+	
+	// Transpose 8 records at a time
+	// Records i to i + 3 go in the low lanes and records i + 4 to i + 7 in the high lanes,
+	// so that a transposition within each lane gives the fields of the 8 records in order
+	for (; i + 8 <= numRecords; i += 8)
+	{
+		const float* src = (const float*)(records + i * 16);
+		
+		__m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)), _mm_loadu_ps(src + 16), 1);
+		__m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)), _mm_loadu_ps(src + 20), 1);
+		__m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)), _mm_loadu_ps(src + 24), 1);
+		__m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 12)), _mm_loadu_ps(src + 28), 1);
+		
+		__m256 t0 = _mm256_unpacklo_ps(r0, r1); // id0 id1 x0 x1
+		__m256 t1 = _mm256_unpacklo_ps(r2, r3); // id2 id3 x2 x3
+		__m256 t2 = _mm256_unpackhi_ps(r0, r1); // y0 y1 z0 z1
+		__m256 t3 = _mm256_unpackhi_ps(r2, r3); // y2 y3 z2 z3
+		
+		_mm256_storeu_si256((__m256i*)(ids + i), _mm256_castps_si256(_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0))));
+		_mm256_storeu_ps(xs + i, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2)));
+		_mm256_storeu_ps(ys + i, _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0)));
+		_mm256_storeu_ps(zs + i, _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2)));
+	}
+	
+	decodeSSE(records + i * 16, numRecords - i, ids + i, xs + i, ys + i, zs + i);
+}
+
+#endif
+
+
+// Choose the fastest implementation supported by the CPU
+static DecodeFunction selectDecodeFunction()
+{
+#if SIMD_X86
+	if (cpuHasAVX()) return decodeAVX;
+	if (cpuHasSSE2()) return decodeSSE;
+#endif
+	return decodeScalar;
+}
+
+
+static const DecodeFunction decodeRecords = selectDecodeFunction();
+
+
+void MapUpdateDecoder::decode(const uint8_t* records, uint32_t numRecords)
+{
+	// The arrays only grow, so that steady-state map updates don't allocate
+	if (ids.size() < numRecords)
+	{
+		ids.resize(numRecords);
+		xs.resize(numRecords);
+		ys.resize(numRecords);
+		zs.resize(numRecords);
+	}
+	
+	if (numRecords == 0) return;
+	
+	decodeRecords(records, numRecords, ids.data(), xs.data(), ys.data(), zs.data());
+}
+
+
+const int32_t* MapUpdateDecoder::getIDs()
+{
+	return ids.data();
+}
+
+
+const float* MapUpdateDecoder::getX()
+{
+	return xs.data();
+}
+
+
+const float* MapUpdateDecoder::getY()
+{
+	return ys.data();
+}
+
+
+const float* MapUpdateDecoder::getZ()
+{
+	return zs.data();
+}
+
+
+const char* MapUpdateDecoder::getImplementationName()
+{
+#if SIMD_X86
+	if (decodeRecords == decodeAVX) return "AVX";
+	if (decodeRecords == decodeSSE) return "SSE";
+#endif
+	return "scalar";
+}
@@ -0,0 +1,53 @@
+#ifndef MAP_UPDATE_DECODER_H
+#define MAP_UPDATE_DECODER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "Simd.h"
+#include "Protocol.h"
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ * 
+ * Batch decoder for the player records of map updates.
+ * 
+ * Each record is 16 bytes: the player ID followed by the x, y and z coordinates.
+ * The records are decoded 4 (SSE) or 8 (AVX) at a time by transposing them into separate ID, x, y and z arrays,
+ * which are then applied to the bot in one pass.
+ * Since the fields are in host byte order on the wire (see Protocol.h), no byte swap is needed, only the transposition.
+ * The implementation is chosen once at runtime based on the CPU, with a scalar fallback.
+ * 
+ *********************************************************************************************************************************************/
+
+class MapUpdateDecoder
+{
+	private:
+	
+		// Decoded records, reused from one map update to the next
+		vector<int32_t> ids;
+		vector<float> xs;
+		vector<float> ys;
+		vector<float> zs;
+		
+	public:
+	
+		// Decode numRecords player records starting at records
+		// The records must be fully inside the frame (see ServerMapUpdateMessage::hasRecords)
+		void decode(const uint8_t* records, uint32_t numRecords);
+		
+		const int32_t* getIDs();
+		
+		const float* getX();
+		
+		const float* getY();
+		
+		const float* getZ();
+		
+		// Get the name of the implementation chosen for this CPU
+		static const char* getImplementationName();
+};
+
+#endif
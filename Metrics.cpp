@@ -0,0 +1,88 @@
+#include "Metrics.h"
+
+
+Metrics::Metrics()
+{
+	for (uint32_t i = 0; i < NUM_MESSAGE_CODES; i++)
+	{
+		numMessages[i].store(0, memory_order_relaxed);
+		numBytes[i].store(0, memory_order_relaxed);
+	}
+	
+	numMapUpdatesDecoded.store(0, memory_order_relaxed);
+	numMapUpdatesShared.store(0, memory_order_relaxed);
+}
+
+
+void Metrics::add(const Metrics& other)
+{
+	for (int i = 0; i < NUM_LATENCIES; i++)
+	{
+		latencies[i].add(other.latencies[i]);
+	}
+	
+	for (uint32_t i = 0; i < NUM_MESSAGE_CODES; i++)
+	{
+		increase(numMessages[i], other.numMessages[i].load(memory_order_relaxed));
+		increase(numBytes[i], other.numBytes[i].load(memory_order_relaxed));
+	}
+	
+	increase(numMapUpdatesDecoded, other.numMapUpdatesDecoded.load(memory_order_relaxed));
+	increase(numMapUpdatesShared, other.numMapUpdatesShared.load(memory_order_relaxed));
+}
+
+
+const LatencyHistogram& Metrics::getLatency(int kind) const
+{
+	return latencies[kind];
+}
+
+
+uint64_t Metrics::getNumMessages(uint8_t code) const
+{
+	return numMessages[code].load(memory_order_relaxed);
+}
+
+
+uint64_t Metrics::getNumBytes(uint8_t code) const
+{
+	return numBytes[code].load(memory_order_relaxed);
+}
+
+
+uint64_t Metrics::getNumMapUpdatesDecoded() const
+{
+	return numMapUpdatesDecoded.load(memory_order_relaxed);
+}
+
+
+uint64_t Metrics::getNumMapUpdatesShared() const
+{
+	return numMapUpdatesShared.load(memory_order_relaxed);
+}
+
+
+const char* Metrics::getLatencyName(int kind)
+{
+	static const char* names[NUM_LATENCIES] = { "recv to decode", "decode to bot update", "decision", "action to send" };
+	
+	return names[kind];
+}
+
+
+const char* Metrics::getMessageName(uint8_t code)
+{
+	static const char* names[NUM_MESSAGE_CODES] =
+	{
+		"unknown",
+		"player move",
+		"player self-annihilate",
+		"player spawn",
+		"player join response",
+		"map update",
+		"player spawn with ID",
+		"annihilation results"
+	};
+	
+	return names[code];
+}
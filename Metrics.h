@@ -0,0 +1,94 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <atomic>
+#include "LatencyHistogram.h"
+#include "Protocol.h"
+
+// Latencies measured by the clients
+#define LATENCY_RECV_TO_DECODE		0	// from the recv of the first bytes of a frame to the start of its decoding
+#define LATENCY_DECODE_TO_UPDATE	1	// from the start of the decoding of a frame to the update of the bot
+#define LATENCY_DECISION			2	// time spent by the bot in performAction
+#define LATENCY_ACTION_TO_SEND		3	// from the queueing of an action to the last of the queued bytes written to the socket
+#define NUM_LATENCIES				4
+
+// Message codes range from 1 to ANNIHILATION_RESULTS, and code 0 counts the frames with an unknown code
+#define NUM_MESSAGE_CODES			(ANNIHILATION_RESULTS + 1)
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ *
+ * Latency histograms and message counters of the clients of an event loop.
+ *
+ * The metrics are only written by the thread of the event loop, so recording costs a few relaxed accesses without contention,
+ * and the reports merge the metrics of all the loops while they run (see Swarm::reportMetrics).
+ * The messages are counted by code, in both directions: codes 1 to 3 are sent by the clients, and codes 4 to 7 by the server.
+ * A message sent is only counted once the socket has accepted all its bytes, so moves replaced by newer ones in the outbound queue
+ * are not counted (see OutboundQueue.h).
+ *
+ *********************************************************************************************************************************************/
+
+class Metrics
+{
+	private:
+		
+		LatencyHistogram latencies[NUM_LATENCIES];
+		atomic<uint64_t> numMessages[NUM_MESSAGE_CODES];
+		atomic<uint64_t> numBytes[NUM_MESSAGE_CODES];
+		atomic<uint64_t> numMapUpdatesDecoded; // map updates decoded by the clients of the loop
+		atomic<uint64_t> numMapUpdatesShared; // map updates that reused a snapshot decoded for another client
+		
+		static inline void increase(atomic<uint64_t>& counter, uint64_t value)
+		{
+			counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed);
+		}
+	
+	public:
+		
+		Metrics();
+		
+		// Record a latency of the given kind (LATENCY_*), only from the thread of the event loop
+		inline void recordLatency(int kind, int64_t nanos)
+		{
+			latencies[kind].record(nanos);
+		}
+		
+		// Count a message sent or received, with its frame header, only from the thread of the event loop
+		inline void countMessage(uint8_t code, uint32_t length)
+		{
+			if (code >= NUM_MESSAGE_CODES) code = 0;
+			
+			increase(numMessages[code], 1);
+			increase(numBytes[code], length);
+		}
+		
+		// Count a map update applied, only from the thread of the event loop
+		inline void countMapUpdate(bool isShared)
+		{
+			increase(isShared ? numMapUpdatesShared : numMapUpdatesDecoded, 1);
+		}
+		
+		// Add the metrics of another event loop to these, which must not be written by another thread meanwhile
+		void add(const Metrics& other);
+		
+		const LatencyHistogram& getLatency(int kind) const;
+		
+		uint64_t getNumMessages(uint8_t code) const;
+		
+		uint64_t getNumBytes(uint8_t code) const;
+		
+		uint64_t getNumMapUpdatesDecoded() const;
+		
+		uint64_t getNumMapUpdatesShared() const;
+		
+		// Get the name of a kind of latency, for the reports
+		static const char* getLatencyName(int kind);
+		
+		// Get the name of a message code, for the reports
+		static const char* getMessageName(uint8_t code);
+};
+
+#endif
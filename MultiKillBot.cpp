@@ -0,0 +1,211 @@
+#include "MultiKillBot.h"
+
+
+// Offsets of the positions reachable within MULTI_KILL_SEARCH_STEPS moves, in number of steps along each axis
+// The offsets are sorted by number of moves, so that the closest positions are scored first if the time budget runs out
+struct SearchOffset
+{
+	int8_t x, y, z;
+	uint8_t numSteps;
+};
+
+
+static vector<SearchOffset> buildSearchOffsets()
+{
+	vector<SearchOffset> offsets;
+	
+	for (int numSteps = 0; numSteps <= MULTI_KILL_SEARCH_STEPS; numSteps++)
+	{
+		for (int x = -numSteps; x <= numSteps; x++)
+		{
+			for (int y = -numSteps; y <= numSteps; y++)
+			{
+				for (int z = -numSteps; z <= numSteps; z++)
+				{
+					if (abs(x) + abs(y) + abs(z) != numSteps) continue;
+					
+					SearchOffset offset = { (int8_t)x, (int8_t)y, (int8_t)z, (uint8_t)numSteps };
+					offsets.push_back(offset);
+				}
+			}
+		}
+	}
+	
+	return offsets;
+}
+
+
+static const vector<SearchOffset> searchOffsets = buildSearchOffsets();
+
+
+// Keep a coordinate inside the arena
+static float clampToArena(float v)
+{
+	if (v < 0) return 0;
+	if (v > 1) return 1;
+	return v;
+}
+
+
+MultiKillBot::MultiKillBot(int ID) : Bot(ID)
+{
+	LOG(LOG_LEVEL_INFO, "Multi-kill bot created\n");
+}
+
+
+uint32_t MultiKillBot::countKills(float x, float y, float z)
+{
+	return countPlayersInRadius(x, y, z, EXPLOSION_RADIUS);
+}
+
+
+void MultiKillBot::stepToward(float x, float y, float z)
+{
+	float xDiff = x - self.x;
+	float yDiff = y - self.y;
+	float zDiff = z - self.z;
+	
+	float* coord = &self.x;
+	float diff = xDiff;
+	
+	if (abs(yDiff) > abs(diff))
+	{
+		coord = &self.y;
+		diff = yDiff;
+	}
+	
+	if (abs(zDiff) > abs(diff))
+	{
+		coord = &self.z;
+		diff = zDiff;
+	}
+	
+	// Don't overshoot the target
+	if (diff > BOT_STEP) diff = BOT_STEP;
+	if (diff < -BOT_STEP) diff = -BOT_STEP;
+	
+	*coord = clampToArena(*coord + diff);
+}
+
+
+int MultiKillBot::performAction()
+{
+	// Do nothing if the player has not been created
+	if (!self.isCreated) return STANDBY;
+	
+	// If cooldown is not finished
+	if (!coolDownDone()) return STANDBY;
+	
+	int64_t deadline = getTime() + MULTI_KILL_TIME_BUDGET;
+	
+	// Decide on the estimated current positions of the other players
+	predictPositions();
+	
+	// If the player is not alive
+	if (!self.isAlive)
+	{
+		// Spawn at the random location with the most players in range
+		
+		uint32_t bestKills = 0;
+		
+		for (int i = 0; i < MULTI_KILL_SPAWN_CANDIDATES; i++)
+		{
+			float x = random.nextBelow(10)/(float)10;
+			float y = random.nextBelow(10)/(float)10;
+			float z = random.nextBelow(10)/(float)10;
+			
+			uint32_t kills = countKills(x, y, z);
+			
+			if (i == 0 || kills > bestKills)
+			{
+				self.x = x;
+				self.y = y;
+				self.z = z;
+				bestKills = kills;
+			}
+			
+			if (getTime() > deadline) break;
+		}
+		
+		self.isAlive = true;
+		
+		// reset the last action time;
+		lastActionTime = getTime();
+		
+		return SPAWN;
+	}
+	
+	// Score the reachable positions, the current one first
+	uint32_t currentKills = 0;
+	float bestValue = 0;
+	float bestX = self.x, bestY = self.y, bestZ = self.z;
+	
+	for (size_t i = 0; i < searchOffsets.size(); i++)
+	{
+		const SearchOffset& offset = searchOffsets[i];
+		
+		float x = clampToArena(self.x + offset.x * BOT_STEP);
+		float y = clampToArena(self.y + offset.y * BOT_STEP);
+		float z = clampToArena(self.z + offset.z * BOT_STEP);
+		
+		uint32_t kills = countKills(x, y, z);
+		float value = kills * pow(MULTI_KILL_STEP_DISCOUNT, offset.numSteps);
+		
+		if (i == 0) currentKills = kills;
+		
+		if (value > bestValue)
+		{
+			bestValue = value;
+			bestX = x;
+			bestY = y;
+			bestZ = z;
+		}
+		
+		// Check the clock every few positions
+		if ((i & 7) == 7 && getTime() > deadline) break;
+	}
+	
+	// Explode if moving is not expected to kill more players
+	if (currentKills > 0 && currentKills >= bestValue)
+	{
+		LOG(LOG_LEVEL_DEBUG, "Exploding at {%.2f, %.2f, %.2f} with %u players in range\n", self.x, self.y, self.z, currentKills);
+		
+		// Self-annihilate
+		self.isAlive = false;
+		lastActionTime = getTime();
+		return EXPLODE;
+	}
+	
+	if (bestValue > 0)
+	{
+		// Move toward the best position found
+		stepToward(bestX, bestY, bestZ);
+	}
+	else
+	{
+		// No player is within reach, so move toward the nearest one
+		Target nearest;
+		
+		if (findNearest(nearest))
+		{
+			stepToward(nearest.x, nearest.y, nearest.z);
+		}
+		else
+		{
+			// The arena is empty, so wander in a random direction
+			float step = (random.nextBelow(2) == 0) ? BOT_STEP : -BOT_STEP;
+			
+			switch (random.nextBelow(3))
+			{
+				case 0: self.x = clampToArena(self.x + step); break;
+				case 1: self.y = clampToArena(self.y + step); break;
+				case 2: self.z = clampToArena(self.z + step); break;
+			}
+		}
+	}
+	
+	// reset the cooldown time
+	lastActionTime = getTime();
+	
+	return MOVE;
+}
@@ -0,0 +1,40 @@
+#ifndef MULTI_KILL_BOT_H
+#define MULTI_KILL_BOT_H
+
+#include "Bot.h"
+
+// Number of moves ahead searched for a better explosion position
+#define MULTI_KILL_SEARCH_STEPS		3
+
+// Time allowed to search for the best position at each action, in nanoseconds
+#define MULTI_KILL_TIME_BUDGET		(200 * NANOS_PER_MICROSECOND)
+
+// Weight of the kills of a position for each move needed to reach it
+// The players are likely to move away while the bot gets there
+#define MULTI_KILL_STEP_DISCOUNT	0.75
+
+// Number of random spawn locations compared when the bot respawns
+#define MULTI_KILL_SPAWN_CANDIDATES	16
+
+class MultiKillBot final: public Bot
+{
+	private:
+	
+		// Get the number of live players an explosion at {x, y, z} would kill
+		uint32_t countKills(float x, float y, float z);
+		
+		// Move the bot one step toward {x, y, z}, along the axis on which it is the farthest
+		void stepToward(float x, float y, float z);
+	
+	public:
+
+		// Create a multi-kill bot
+		// Assign an ID to the bot
+		MultiKillBot(int ID);
+		
+		// Score the positions reachable within a few moves by the number of players an explosion there would kill
+		// Explode if no reachable position is expected to kill more, otherwise move toward the best one
+		int performAction() override;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "Notifier.h"
+
+
+Notifier::Notifier(bool isBlocking)
+{
+	eventfd = ::eventfd(0, EFD_CLOEXEC | (isBlocking ? 0 : EFD_NONBLOCK));
+	
+	if (eventfd == -1)
+	{
+		LOG(LOG_LEVEL_ERROR, "Failed to create eventfd: %s\n", strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	
+	isPending = false;
+}
+
+
+Notifier::~Notifier()
+{
+	close(eventfd);
+}
+
+
+int Notifier::getFD()
+{
+	return eventfd;
+}
+
+
+void Notifier::notify()
+{
+	// The sleeper is already being woken up
+	if (isPending.exchange(true)) return;
+	
+	uint64_t one = 1;
+	
+	while (write(eventfd, &one, sizeof(one)) == -1 && errno == EINTR);
+}
+
+
+void Notifier::consume()
+{
+	uint64_t count;
+	
+	while (read(eventfd, &count, sizeof(count)) == -1 && errno == EINTR);
+	
+	// Work posted from now on notifies again
+	isPending = false;
+}
@@ -0,0 +1,54 @@
+#ifndef NOTIFIER_H
+#define NOTIFIER_H
+
+#include <sys/eventfd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <atomic>
+#include "Log.h"
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ * 
+ * Wakes up a thread that sleeps until work is posted to it from other threads, through an eventfd.
+ * 
+ * The eventfd can be watched by an epoll event loop, or a thread can block reading it.
+ * Only the first notification after the sleeper last woke up writes to the eventfd,
+ * so that a burst of work posted by many threads costs a single system call.
+ * The sleeper must call consume() before it checks for work, so that no notification is lost in between.
+ * 
+ *********************************************************************************************************************************************/
+
+class Notifier
+{
+	private:
+	
+		int eventfd; // counter of notifications, readable when non-zero
+		atomic<bool> isPending; // set from the first notification until the sleeper consumes it
+		
+	public:
+	
+		// Create a notifier with its own eventfd
+		// If isBlocking is false, the eventfd is non-blocking, to be watched by an event loop
+		Notifier(bool isBlocking);
+		
+		~Notifier();
+		
+		// Get the file descriptor to watch for notifications
+		int getFD();
+		
+		// Wake up the sleeper, from any thread
+		void notify();
+		
+		// Clear the notifications, so that the next notify() wakes up the sleeper again
+		// With a blocking eventfd, block until there is a notification
+		void consume();
+};
+
+#endif
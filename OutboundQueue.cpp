@@ -0,0 +1,151 @@
+#include "OutboundQueue.h"
+
+
+OutboundQueue::OutboundQueue()
+{
+	head = 0;
+	count = 0;
+	headOffset = 0;
+	isReplacing = false;
+}
+
+
+bool OutboundQueue::hasReplaceableTail()
+{
+	if (count == 0) return false;
+	
+	// The first frame can't be replaced once part of it is on the wire
+	if (count == 1 && headOffset > 0) return false;
+	
+	return frames[(head + count - 1) & (OUTBOUND_QUEUE_SIZE - 1)].type == COALESCED_FRAME_TYPE;
+}
+
+
+uint8_t* OutboundQueue::reserve(uint8_t type)
+{
+	// The newest position replaces the stale one that is still waiting
+	if (type == COALESCED_FRAME_TYPE && hasReplaceableTail())
+	{
+		isReplacing = true;
+		return frames[(head + count - 1) & (OUTBOUND_QUEUE_SIZE - 1)].data;
+	}
+	
+	if (isFull()) return NULL;
+	
+	OutboundFrame* frame = &frames[(head + count) & (OUTBOUND_QUEUE_SIZE - 1)];
+	frame->type = type;
+	frame->length = 0;
+	isReplacing = false;
+	
+	return frame->data;
+}
+
+
+void OutboundQueue::commit(uint32_t numBytes)
+{
+	if (isReplacing)
+	{
+		frames[(head + count - 1) & (OUTBOUND_QUEUE_SIZE - 1)].length = numBytes;
+		isReplacing = false;
+		return;
+	}
+	
+	frames[(head + count) & (OUTBOUND_QUEUE_SIZE - 1)].length = numBytes;
+	count++;
+}
+
+
+bool OutboundQueue::hasSendableFrames(bool holdLatestMove)
+{
+	uint32_t held = (holdLatestMove && hasReplaceableTail()) ? 1 : 0;
+	
+	return count > held;
+}
+
+
+int OutboundQueue::flush(int sockfd, bool holdLatestMove, Metrics& metrics)
+{
+	struct iovec iov[OUTBOUND_QUEUE_SIZE];
+	
+	while (hasSendableFrames(holdLatestMove))
+	{
+		// The held move frame is left out
+		uint32_t numFrames = (holdLatestMove && hasReplaceableTail()) ? count - 1 : count;
+		
+		// Gather the queued frames, starting at the unsent part of the first frame
+		for (uint32_t i = 0; i < numFrames; i++)
+		{
+			OutboundFrame* frame = &frames[(head + i) & (OUTBOUND_QUEUE_SIZE - 1)];
+			
+			iov[i].iov_base = frame->data;
+			iov[i].iov_len = frame->length;
+		}
+		
+		iov[0].iov_base = frames[head].data + headOffset;
+		iov[0].iov_len -= headOffset;
+		
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = numFrames;
+		
+		ssize_t bytes = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+		
+		if (bytes == -1)
+		{
+			// The socket is full, the rest is sent when it becomes writable again
+			if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+			if (errno == EINTR) continue;
+			
+			LOG(LOG_LEVEL_ERROR, "Error sending message to server: %s\n", strerror(errno));
+			
+			// Drop the frames, retrying a failed socket would not succeed
+			clear();
+			return -1;
+		}
+		
+		// Remove the frames that are completely sent
+		size_t remaining = (size_t)bytes;
+		
+		while (count > 0 && remaining >= frames[head].length - headOffset)
+		{
+			remaining -= frames[head].length - headOffset;
+			metrics.countMessage(frames[head].type, frames[head].length);
+			headOffset = 0;
+			head = (head + 1) & (OUTBOUND_QUEUE_SIZE - 1);
+			count--;
+		}
+		
+		// Remember how much of the first frame is sent
+		headOffset += remaining;
+	}
+	
+	return 0;
+}
+
+
+void OutboundQueue::clear()
+{
+	head = 0;
+	count = 0;
+	headOffset = 0;
+	isReplacing = false;
+}
+
+
+bool OutboundQueue::isEmpty()
+{
+	return count == 0;
+}
+
+
+bool OutboundQueue::isFull()
+{
+	return count == OUTBOUND_QUEUE_SIZE;
+}
+
+
+uint32_t OutboundQueue::size()
+{
+	return count;
+}
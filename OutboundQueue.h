@@ -0,0 +1,95 @@
+#ifndef OUTBOUND_QUEUE_H
+#define OUTBOUND_QUEUE_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "Protocol.h"
+#include "Metrics.h"
+#include "Log.h"
+
+#define OUTBOUND_FRAME_SIZE		32	// large enough for the biggest message sent by the client
+#define OUTBOUND_QUEUE_SIZE		64	// maximum number of frames waiting to be sent (power of 2)
+
+// Message code of the frames that only matter until a newer one of the same type is queued
+#define COALESCED_FRAME_TYPE	PLAYER_MOVE
+
+using namespace std;
+
+static_assert(PlayerMoveMessage::FIXED_SIZE <= OUTBOUND_FRAME_SIZE && PlayerSpawnMessage::FIXED_SIZE <= OUTBOUND_FRAME_SIZE, "Outbound frames are too small");
+
+
+typedef struct
+{
+	uint8_t data[OUTBOUND_FRAME_SIZE];
+	uint32_t length;
+	uint8_t type; // message code of the frame
+	
+} OutboundFrame;
+
+
+/********************************************************************************************************************************************
+ * 
+ * The outbound queue holds the frames that are waiting to be written to a connection.
+ * Frames are encoded directly into the queue, and are written to the socket in a single sendmsg call when several are pending.
+ * If the socket only accepts part of the frames, the unsent bytes stay in the queue (including the rest of a partially-sent frame),
+ * so that a frame is never left half-written on the stream.
+ * 
+ * Only the latest position of the player matters to the server, so move frames are coalesced:
+ * a new move frame replaces a move frame at the end of the queue if none of its bytes are sent yet.
+ * Since only the last frame is ever replaced, spawn and self-annihilate frames keep their order relative to all other frames.
+ * When the connection is congested, the last move frame can also be held back so that it keeps being replaced by newer positions
+ * instead of adding stale positions to the backlog.
+ * 
+ *********************************************************************************************************************************************/
+
+class OutboundQueue
+{
+	private:
+	
+		OutboundFrame frames[OUTBOUND_QUEUE_SIZE]; // ring buffer of frames
+		uint32_t head; // index of the first frame to send
+		uint32_t count; // number of frames in the queue
+		uint32_t headOffset; // number of bytes of the first frame that are already sent
+		bool isReplacing; // true if the last reserve() returned the frame at the end of the queue to be overwritten
+		
+		// Return true if the last frame is a move frame that has not started to be sent
+		bool hasReplaceableTail();
+		
+	public:
+	
+		OutboundQueue();
+		
+		// Get a free frame at the end of the queue to encode a message of the given type into
+		// A move frame reuses the unsent move frame at the end of the queue if there is one
+		// Return NULL if the queue is full
+		// The frame is only queued once commit() is called
+		uint8_t* reserve(uint8_t type);
+		
+		// Queue the frame returned by the last reserve(), containing numBytes bytes
+		void commit(uint32_t numBytes);
+		
+		// Write as many queued frames as the socket accepts
+		// If holdLatestMove is true, an unsent move frame at the end of the queue is kept in the queue
+		// Each frame is counted as sent in metrics once the socket has accepted all its bytes, so replaced frames are never counted
+		// Return 0 on success (even if some frames are still queued), -1 if the socket failed
+		int flush(int sockfd, bool holdLatestMove, Metrics& metrics);
+		
+		// Return true if flush() would have something to write
+		bool hasSendableFrames(bool holdLatestMove);
+		
+		// Drop all queued frames
+		void clear();
+		
+		bool isEmpty();
+		
+		bool isFull();
+		
+		uint32_t size();
+};
+
+#endif
@@ -19,7 +19,7 @@ addrinfo* PlayerClient::getTCPServerAddrInfo(const char* hostName, const char* p
 	
 	if (result != 0)
 	{
-		fprintf(stderr, "Error resolving port %s: %s\n", portNum, gai_strerror(result));
+		LOG(LOG_LEVEL_ERROR, "Error resolving port %s: %s\n", portNum, gai_strerror(result));
 		return NULL;
 	}
 	
@@ -46,12 +46,22 @@ TCPHost* PlayerClient::createTCPServer(const char* hostName, const char* portNum
 	
 	if (host == NULL)
 	{
-		fprintf(stderr, "Failed to allocate memory for TCP server.\n");
+		LOG(LOG_LEVEL_ERROR, "Failed to allocate memory for TCP server.\n");
 		return NULL;
 	}
 	
 	memset(host, 0, sizeof(TCPHost));
 	
+	// The receive buffer grows when a frame doesn't fit in it
+	host->recvBuffer = BufferPool::acquire(BUFFER_SIZE, host->recvCapacity);
+	
+	if (host->recvBuffer == NULL)
+	{
+		LOG(LOG_LEVEL_ERROR, "Failed to allocate memory for TCP server.\n");
+		free(host);
+		return NULL;
+	}
+	
 	host->sockfd = sockfd; 
 	host->hostName = hostName;
 	host->portNum = portNum;
@@ -78,7 +88,7 @@ int PlayerClient::createSocketFD(struct addrinfo* hostAddr)
 		
 		if (sockfd == - 1)
 		{
-			perror("Unable to create socket ");
+			LOG(LOG_LEVEL_ERROR, "Unable to create socket: %s\n", strerror(errno));
 			continue;
 		}
 		break;
@@ -86,7 +96,7 @@ int PlayerClient::createSocketFD(struct addrinfo* hostAddr)
 	
 	if (p == NULL)
 	{
-		fprintf(stderr, "Failed to bind socket to a valid server address.\n");
+		LOG(LOG_LEVEL_ERROR, "Failed to bind socket to a valid server address.\n");
 		return -1;
 	}
 	
@@ -103,7 +113,7 @@ int PlayerClient::setSocketNonBlocking(int sockfd)
 	
 	if (flags == -1)
 	{
-		perror("Failed to get socket flags using fcntl() ");
+		LOG(LOG_LEVEL_ERROR, "Failed to get socket flags using fcntl(): %s\n", strerror(errno));
 		return flags;
 	}
 	
@@ -112,33 +122,59 @@ int PlayerClient::setSocketNonBlocking(int sockfd)
 	
 	if (res == -1)
 	{
-		perror("Failed to set socket to non-blocking using fcntl() ");
+		LOG(LOG_LEVEL_ERROR, "Failed to set socket to non-blocking using fcntl(): %s\n", strerror(errno));
 	}
 	
 	return res;
 }
 
 
-PlayerClient::PlayerClient(const char* serverHostName, const char* serverPortNum, int AIType)
+PlayerClient::PlayerClient(const char* serverHostName, const char* serverPortNum, int AIType, SharedWorld* sharedWorld, int64_t slack)
 {
 	server = createTCPServer(serverHostName, serverPortNum);
 	
 	if (server == NULL)
 	{
-		fprintf(stderr, "ERROR: game server not created\n");
+		LOG(LOG_LEVEL_ERROR, "Game server not created\n");
 		exit(EXIT_FAILURE);
 	}
 	
-	// Since the server socket is the first socket
-	// It is also the maximum socket fd
-	maxfd = server->sockfd;
-	
-	timeout.tv_sec = 0;
-	timeout.tv_usec = 2000;
-
 	botAIType = AIType;
-	
-	fprintf(stdout, "Player client created\n");
+	botTypeIndex = BotFactory::getTypeIndex(AIType);
+	bot = NULL;
+	world = sharedWorld;
+	loop = NULL;
+	isConnecting = false;
+	isThrottled = false;
+	watchedEvents = 0;
+	skippedMapUpdates = 0;
+	
+	decisionSlack = slack;
+	lastMapUpdateTime = -1;
+	mapUpdatePeriod = MAP_UPDATE_MILLISEC * NANOS_PER_MILLISECOND;
+	mapUpdateApplied = false;
+	
+	isDeciding = false;
+	decidedAction = STANDBY;
+	nextDecision = NULL;
+	
+	recvTime = -1;
+	decisionNanos = 0;
+	actionTime = -1;
+	
+	socketSource.client = this;
+	socketSource.type = SOCKET_EVENT;
+	timerSource.client = this;
+	timerSource.type = TIMER_EVENT;
+	
+	// The action timer expires when the bot's action cooldown is over
+	// It is scheduled on the timing wheel of the event loop, on the monotonic clock,
+	// so that the bot is paced by elapsed time while the client is idle
+	memset(&actionTimer, 0, sizeof(actionTimer));
+	actionTimer.level = -1;
+	actionTimer.source = &timerSource;
+	
+	LOG(LOG_LEVEL_INFO, "Player client created\n");
 }
 
 
@@ -147,104 +183,396 @@ PlayerClient::~PlayerClient()
 	if (server != NULL)
 	{
 		close(server->sockfd);
-		delete server;
+		BufferPool::release(server->recvBuffer, server->recvCapacity);
+		free(server);
 	}
 	if (bot != NULL) delete bot;
 }
 
 
-void PlayerClient::run()
+int PlayerClient::start(EventLoop* eventLoop)
 {
-	fprintf(stdout, "Player client started\n");
+	loop = eventLoop;
 	
 	int res = connectToServer();
 	
 	// If there's an error, terminate
 	if (res == -1)
 	{
-		fprintf(stderr, "Failed to connect to the server: %s\n", strerror(errno));
-		return;
+		LOG(LOG_LEVEL_ERROR, "Failed to connect to the server: %s\n", strerror(errno));
+		server->isClosed = true;
+		return -1;
 	}
 	
-	fprintf(stdout, "Connected to server %s at port %s\n", server->hostName, server->portNum);
+	// The socket becomes writable once a non-blocking connect completes
+	watchedEvents = isConnecting ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
 	
-	while (true)
+	if (loop->watch(server->sockfd, watchedEvents, &socketSource) == -1)
 	{
-		// Reset the file descriptor master set
-		// The master set is used to keep track of active sockets
-		// Once all active sockets are added to the master set
-		// The master set is copied to all other fd sets
-		FD_ZERO(&masterSet);
-		
-		// Add all active sockets to the master set
-		// Currently the server socket is the only active socket
-		FD_SET(server->sockfd, &masterSet);
-		
-		// Copy the master set to other fd sets
-		readSet = masterSet;
-		writeSet = masterSet;
-		exceptSet = masterSet;
-		
-		// Use select to wait for socket activity
-		res = select(maxfd + 1, &readSet, &writeSet, &exceptSet, &timeout);
-		
-		// If there's an error
-		if (res == -1)
+		server->isClosed = true;
+		return -1;
+	}
+	
+	if (!isConnecting)
+	{
+		LOG(LOG_LEVEL_INFO, "Connected to server %s at port %s\n", server->hostName, server->portNum);
+	}
+	
+	return 0;
+}
+
+
+bool PlayerClient::isClosed()
+{
+	return server->isClosed;
+}
+
+
+void PlayerClient::handleEvent(int type, uint32_t events)
+{
+	if (server->isClosed) return;
+	
+	if (type == TIMER_EVENT)
+	{
+		// The bot is due to take an action
+		performBotAction();
+		armActionTimer();
+	}
+	else if (type == DECISION_EVENT)
+	{
+		// The decision of the bot is back from the decision pool
+		completeBotAction();
+		armActionTimer();
+	}
+	else
+	{
+		// If the non-blocking connect has completed
+		if (isConnecting && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
 		{
-			fprintf(stderr, "Error waiting for socket activity: %s\n", strerror(errno));
-			continue;
+			if (finishConnect() == -1)
+			{
+				disconnect();
+				return;
+			}
 		}
 		
 		// If the server sends a message
-		if (FD_ISSET(server->sockfd, &readSet))
+		if (!isConnecting && (events & (EPOLLIN | EPOLLERR | EPOLLHUP)))
 		{
-			//fprintf(stdout, "Message received from server\n");
-			
 			int code = processServerMessage();
 			
 			if (code == -1)
 			{
-				fprintf(stderr, "Error processing message from server\n");
-			}		
-		}
-		// If the socket is ready to be written to 
-		if (FD_ISSET(server->sockfd, &writeSet))
-		{
-			int action = STANDBY;
-			
-			if (bot != NULL)
-			{
-				action = bot->performAction();
+				LOG(LOG_LEVEL_ERROR, "Error processing message from server\n");
 			}
 			
-			switch(action)
+			// When actions are scheduled on map updates, a bot whose cooldown is over acts on the update it just received
+			if (mapUpdateApplied)
 			{
-				case MOVE:
-					sendPlayerMoveMessage();
-					break;
-					
-				case EXPLODE:
-					sendPlayerSelfAnnihilateMessage();
-					break;
-					
-				case SPAWN:
-					sendPlayerSpawnMessage();
-					break;
-					
-				case STANDBY:
-					// do nothing
-					break;
-					
-				default:
-					break;
+				mapUpdateApplied = false;
+				
+				if (decisionSlack >= 0 && bot != NULL && !isDeciding && bot->coolDownDone()) performBotAction();
 			}
+			
+			// Server messages may create the bot or reset its cooldown
+			armActionTimer();
+		}
+	}
+	
+	// Write the queued frames in one go
+	// These are the frames produced by this event and the ones left over when the socket was full
+	if (!server->isClosed && !isConnecting && !outbound.isEmpty())
+	{
+		bool wasFull = outbound.isFull();
+		
+		// While the connection is congested, the latest move is held back and keeps being replaced by newer positions
+		isThrottled = isSendQueueCongested();
+		
+		if (outbound.flush(server->sockfd, isThrottled, loop->getMetrics()) == -1)
+		{
+			LOG(LOG_LEVEL_ERROR, "Failed to send queued messages to server\n");
+			server->isClosed = true;
 		}
-		if (FD_ISSET(server->sockfd, &exceptSet))
+		else
 		{
-			// No game logic for now
-			// No error handling for now
+			// The actions are sent once nothing is left in the queue, including a held back move
+			if (actionTime >= 0 && outbound.isEmpty())
+			{
+				loop->getMetrics().recordLatency(LATENCY_ACTION_TO_SEND, monotonicNow() - actionTime);
+				actionTime = -1;
+			}
+			
+			// The bot may act again once there is room in the queue
+			if (wasFull && !outbound.isFull()) armActionTimer();
 		}
 	}
+	
+	if (server->isClosed)
+	{
+		disconnect();
+		return;
+	}
+	
+	updateWatchedEvents();
+}
+
+
+int PlayerClient::finishConnect()
+{
+	int error = 0;
+	socklen_t len = sizeof(error);
+	
+	if (getsockopt(server->sockfd, SOL_SOCKET, SO_ERROR, &error, &len) == -1) error = errno;
+	
+	if (error != 0)
+	{
+		LOG(LOG_LEVEL_ERROR, "Failed to connect to the server: %s\n", strerror(error));
+		return -1;
+	}
+	
+	isConnecting = false;
+	
+	LOG(LOG_LEVEL_INFO, "Connected to server %s at port %s\n", server->hostName, server->portNum);
+	
+	return 0;
+}
+
+
+void PlayerClient::updateWatchedEvents()
+{
+	// A connected socket is almost always writable
+	// So only wait for it to become writable while connecting or when there is unsent data
+	uint32_t events = EPOLLIN;
+	
+	// A held back move is retried on the next event rather than when the socket becomes writable,
+	// since a congested socket may still be writable
+	if (isConnecting || outbound.hasSendableFrames(isThrottled)) events |= EPOLLOUT;
+	
+	if (events != watchedEvents)
+	{
+		loop->modify(server->sockfd, events, &socketSource);
+		watchedEvents = events;
+	}
+}
+
+
+bool PlayerClient::isSendQueueCongested()
+{
+	int queued = 0;
+	
+	// Number of bytes in the kernel send queue that are not acknowledged by the server yet
+	if (ioctl(server->sockfd, SIOCOUTQ, &queued) == -1) return false;
+	
+	return queued > SEND_QUEUE_THROTTLE_BYTES;
+}
+
+
+void PlayerClient::disconnect()
+{
+	server->isClosed = true;
+	
+	loop->unwatch(server->sockfd);
+	loop->cancel(&actionTimer);
+	loop->clientClosed();
+}
+
+
+void PlayerClient::performBotAction()
+{
+	// The bot does not act before the player joins the game
+	// or while there is no room to queue its message
+	if (bot == NULL || outbound.isFull() || isDeciding) return;
+	
+	// The decision is taken on a worker, and the bot is left alone until it is back
+	if (loop->hasDecisionPool())
+	{
+		isDeciding = true;
+		loop->submitDecision(this);
+		return;
+	}
+	
+	int64_t start = monotonicNow();
+	int action = BotFactory::performAction(botTypeIndex, bot);
+	
+	loop->getMetrics().recordLatency(LATENCY_DECISION, monotonicNow() - start);
+	
+	sendBotAction(action);
+}
+
+
+void PlayerClient::decideBotAction()
+{
+	takeBotDecision();
+	
+	loop->postDecision(this);
+}
+
+
+void PlayerClient::takeBotDecision()
+{
+	// The time is recorded once the decision is back on the thread of the event loop, which owns the metrics
+	int64_t start = monotonicNow();
+	
+	decidedAction = BotFactory::performAction(botTypeIndex, bot);
+	decisionNanos = monotonicNow() - start;
+}
+
+
+PlayerClient* PlayerClient::getNextDecision()
+{
+	return nextDecision;
+}
+
+
+void PlayerClient::setNextDecision(PlayerClient* client)
+{
+	nextDecision = client;
+}
+
+
+void PlayerClient::completeBotAction()
+{
+	isDeciding = false;
+	
+	loop->getMetrics().recordLatency(LATENCY_DECISION, decisionNanos);
+	
+	sendBotAction(decidedAction);
+	
+	for (size_t i = 0; i < deferredEvents.size(); i++)
+	{
+		applyBotEvent(deferredEvents[i]);
+	}
+	
+	deferredEvents.clear();
+}
+
+
+void PlayerClient::deliverBotEvent(const BotEvent& event)
+{
+	if (isDeciding) deferredEvents.push_back(event);
+	else applyBotEvent(event);
+}
+
+
+void PlayerClient::applyBotEvent(const BotEvent& event)
+{
+	loop->getMetrics().recordLatency(LATENCY_DECODE_TO_UPDATE, monotonicNow() - event.decodeTime);
+	
+	switch(event.type)
+	{
+		case BOT_EVENT_WORLD:
+			bot->setWorld(event.world);
+			break;
+			
+		case BOT_EVENT_SPAWN:
+			bot->playerSpawnUpdate(event.playerID, event.x, event.y, event.z);
+			break;
+			
+		case BOT_EVENT_KILLED:
+			bot->playerKilledUpdate(event.playerID);
+			break;
+			
+		case BOT_EVENT_KILLER:
+			bot->setKiller(event.playerID);
+			break;
+			
+		case BOT_EVENT_SCORE:
+			bot->incrementScore(event.playerID);
+			break;
+			
+		default:
+			break;
+	}
+}
+
+
+void PlayerClient::sendBotAction(int action)
+{
+	int res = -1;
+	
+	switch(action)
+	{
+		case MOVE:
+			res = sendPlayerMoveMessage();
+			break;
+			
+		case EXPLODE:
+			res = sendPlayerSelfAnnihilateMessage();
+			break;
+			
+		case SPAWN:
+			res = sendPlayerSpawnMessage();
+			break;
+			
+		case STANDBY:
+			// do nothing
+			break;
+			
+		default:
+			break;
+	}
+	
+	// The latency runs from the oldest action still queued, since later ones are sent in the same write
+	if (res == 0 && actionTime < 0) actionTime = monotonicNow();
+}
+
+
+void PlayerClient::armActionTimer()
+{
+	// The timer stays cancelled until there is a bot that can act
+	// An overdue deadline expires at the next tick of the timing wheel
+	if (bot != NULL && !outbound.isFull() && !isDeciding)
+	{
+		loop->schedule(&actionTimer, getActionDeadline());
+	}
+	else
+	{
+		loop->cancel(&actionTimer);
+	}
+}
+
+
+int64_t PlayerClient::getActionDeadline()
+{
+	int64_t deadline = bot->getNextActionTime();
+	
+	// Without any map update to go by, the bot acts when its cooldown is over
+	if (decisionSlack < 0 || lastMapUpdateTime < 0) return deadline;
+	
+	int64_t cooldownEnd = deadline;
+	int64_t now = Bot::getTime();
+	
+	if (cooldownEnd < now) cooldownEnd = now;
+	
+	// Predict the first map update after the cooldown, assuming the updates keep arriving at the estimated period
+	int64_t periods = (cooldownEnd - lastMapUpdateTime + mapUpdatePeriod - 1) / mapUpdatePeriod;
+	int64_t nextMapUpdate = lastMapUpdateTime + periods * mapUpdatePeriod;
+	
+	// If it comes too late, the bot does not wait for it
+	if (nextMapUpdate - cooldownEnd > decisionSlack) return deadline;
+	
+	// Otherwise the map update triggers the action, and the timer only fires if it does not arrive in time
+	return cooldownEnd + decisionSlack;
+}
+
+
+void PlayerClient::recordMapUpdate()
+{
+	int64_t now = Bot::getTime();
+	
+	if (lastMapUpdateTime >= 0)
+	{
+		int64_t interval = now - lastMapUpdateTime;
+		
+		// An interval much longer than the period is most likely a hiccup, so it only stretches the estimate a little
+		if (interval > 2 * mapUpdatePeriod) interval = 2 * mapUpdatePeriod;
+		
+		// Map updates processed by the same event don't tell anything about the period
+		if (interval > NANOS_PER_MILLISECOND) mapUpdatePeriod += (interval - mapUpdatePeriod) / MAP_UPDATE_PERIOD_GAIN;
+	}
+	
+	lastMapUpdateTime = now;
+	mapUpdateApplied = true;
 }
 
 
@@ -255,325 +583,343 @@ int PlayerClient::connectToServer()
 	// If there's an error, retry 3 times
 	int count = 3;
 	
-	while (res == -1 && count > 0)
+	while (res == -1 && errno != EINPROGRESS && count > 0)
 	{
 		res = connect(server->sockfd, &server->addr, server->addrlen);
 		count--;
 	}
 	
+	// The non-blocking socket finishes connecting in the background
+	if (res == -1 && errno == EINPROGRESS)
+	{
+		isConnecting = true;
+		return 0;
+	}
+	
 	return res;
 }
 
 
 int PlayerClient::processServerMessage()
 {
-	ssize_t bytes = recv(server->sockfd, server->recvBuffer, BUFFER_SIZE, 0); 
+	int res = 0;
+	
+	// Drain the socket until it would block
+	// The frames are decoded in batches, each time the buffer is full and once the socket is drained
+	// so that a batch holds as many frames as possible
+	while (true)
+	{
+		// Make room for the next recv
+		if (server->recvLength == server->recvCapacity)
+		{
+			if (processBufferedFrames() == -1) res = -1;
+			
+			// Grow the buffer if the next frame is larger than the buffer
+			if (fitRecvBuffer() == -1)
+			{
+				server->isClosed = true;
+				return -1;
+			}
+		}
+		
+		ssize_t bytes = recv(server->sockfd, server->recvBuffer + server->recvLength, server->recvCapacity - server->recvLength, 0);
+		
+		if (bytes == -1)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			if (errno == EINTR) continue;
+			
+			LOG(LOG_LEVEL_ERROR, "Error receiving server message: %s\n", strerror(errno));
+			server->isClosed = true;
+			return -1;
+		}
+		if (bytes == 0)
+		{
+			LOG(LOG_LEVEL_INFO, "Connection closed by server\n");
+			server->isClosed = true;
+			break;
+		}
+		
+		if (recvTime < 0) recvTime = monotonicNow();
+		
+		server->recvLength += bytes;
+	}
 	
-	if (bytes == -1)
+	if (processBufferedFrames() == -1) res = -1;
+	
+	// Grow the buffer for a large incoming frame, or give back a large buffer that is no longer needed
+	if (fitRecvBuffer() == -1)
 	{
-		fprintf(stderr, "Error receiving server message: %s\n", strerror(errno));
+		server->isClosed = true;
 		return -1;
 	}
-	if (bytes == 0)
+	
+	return res;
+}
+
+
+int PlayerClient::fitRecvBuffer()
+{
+	// Size needed for the frame at the beginning of the buffer, if its length is known yet
+	uint32_t needed = BUFFER_SIZE;
+	
+	if (server->recvLength >= 4)
+	{
+		uint32_t numBytes = readFrameLength(server->recvBuffer);
+		
+		if (numBytes > needed) needed = numBytes;
+	}
+	
+	// Large buffers are only kept while a large frame is being received
+	bool isTooSmall = needed > server->recvCapacity;
+	bool isTooLarge = server->recvCapacity > RECV_BUFFER_SHRINK_SIZE && needed <= RECV_BUFFER_SHRINK_SIZE;
+	
+	if (!isTooSmall && !isTooLarge) return 0;
+	
+	uint32_t capacity;
+	uint8_t* buffer = BufferPool::acquire(needed, capacity);
+	
+	if (buffer == NULL)
 	{
-		return 0;
+		LOG(LOG_LEVEL_ERROR, "Failed to allocate a receive buffer of %u bytes\n", needed);
+		return -1;
 	}
 	
-	// Read the number of bytes in the packet
-	uint32_t rawBytes = 0;
-	rawBytes |= ((uint32_t)server->recvBuffer[0]) << 24;
-	rawBytes |= ((uint32_t)server->recvBuffer[1]) << 16;
-	rawBytes |= ((uint32_t)server->recvBuffer[2]) << 8;
-	rawBytes |= ((uint32_t)server->recvBuffer[3]);
+	// Keep the bytes of the incomplete frame
+	memcpy(buffer, server->recvBuffer, server->recvLength);
+	
+	BufferPool::release(server->recvBuffer, server->recvCapacity);
+	
+	server->recvBuffer = buffer;
+	server->recvCapacity = capacity;
 	
-	uint32_t numBytes = ntohl(rawBytes);
+	return 0;
+}
+
+
+int PlayerClient::processBufferedFrames()
+{
+	int res = 0;
+	uint32_t end = 0;
+	
+	// Only the latest map update of the batch is applied, since each map update is a full snapshot of the players
+	// Spawn and annihilation events are all applied in their order
+	// -1 if there's no map update in the batch
+	int64_t latestMapUpdate = -1;
 	
-	// If the number of bytes actually received is less than the expected number of bytes
-	if (bytes < numBytes)
+	// Find the complete frames in the buffer
+	while (server->recvLength - end >= 4)
 	{
-		fprintf(stderr, "Number of bytes received from server is less than expected. Received %ld bytes, expected %u bytes\n", bytes, numBytes);
+		uint32_t numBytes = readFrameLength(server->recvBuffer + end);
 		
-		for (int i = 0; i < bytes; i++)
+		// A frame must at least hold the header
+		// Otherwise the stream can no longer be parsed, so the buffered bytes are dropped
+		if (numBytes < FRAME_HEADER_SIZE)
 		{
-			fprintf(stdout, "byte %d: %d\n", i, server->recvBuffer[i]);
+			LOG(LOG_LEVEL_ERROR, "Invalid frame length in server message: %u bytes\n", numBytes);
+			server->recvLength = 0;
+			recvTime = -1;
+			return -1;
 		}
 		
-		return -1;
+		// Wait for the rest of a split frame
+		if (server->recvLength - end < numBytes) break;
+		
+		if (server->recvBuffer[end + 5] == SERVER_MAP_UPDATE) latestMapUpdate = end;
+		
+		end += numBytes;
+	}
+	
+	// Decode the complete frames
+	for (uint32_t index = 0; index < end; )
+	{
+		uint8_t* frame = server->recvBuffer + index;
+		uint32_t numBytes = readFrameLength(frame);
+		
+		loop->getMetrics().countMessage(frame[5], numBytes);
+		
+		// Skip the map updates that are superseded by a newer one in the same batch
+		if (frame[5] == SERVER_MAP_UPDATE && (int64_t)index != latestMapUpdate)
+		{
+			skippedMapUpdates++;
+		}
+		else if (processFrame(frame, numBytes) == -1)
+		{
+			res = -1;
+		}
+		
+		index += numBytes;
 	}
+	
+	// Move the leftover bytes of an incomplete frame to the beginning of the buffer
+	if (end > 0)
+	{
+		server->recvLength -= end;
+		memmove(server->recvBuffer, server->recvBuffer + end, server->recvLength);
+	}
+	
+	// The bytes of an incomplete frame keep the time of the batch, which makes their recv to decode latency an upper bound
+	if (server->recvLength == 0) recvTime = -1;
+	
+	return res;
+}
+
+
+int PlayerClient::processFrame(const uint8_t* frame, uint32_t numBytes)
+{
+	int64_t decodeTime = monotonicNow();
+	
+	loop->getMetrics().recordLatency(LATENCY_RECV_TO_DECODE, decodeTime - recvTime);
+	
 	// Check the version number
-	if (server->recvBuffer[4] != VERSION_NUM)
+	if (frame[4] != VERSION_NUM)
 	{
-		fprintf(stderr, "Wrong version number in server message\n");
+		LOG(LOG_LEVEL_ERROR, "Wrong version number in server message\n");
 		return -1;
 	}
 	
 	int res = 0;
 	
 	// Check the message code
-	switch(server->recvBuffer[5])
+	switch(frame[5])
 	{
 		case PLAYER_JOIN_RESPONSE:
 		{
-			// 10 bytes are expected for player join response message
-			if (numBytes != 10)
+			int32_t botID;
+			
+			if (!PlayerJoinResponseMessage::decode(frame, numBytes, botID))
 			{
-				fprintf(stderr, "Wrong number of bytes received in player join response message: %u\n", numBytes);
-				
-				for (int i = 0; i < (int)numBytes; i++)
-				{
-					fprintf(stdout, "Byte %d: %d\n", i, server->recvBuffer[i]);
-				}
+				LOG(LOG_LEVEL_ERROR, "Wrong number of bytes received in player join response message: %u\n", numBytes);
+				dumpFrame(frame, numBytes);
 				res = -1;
+				break;
 			}
-			else
-			{
-				// Read the player ID
-				int32_t rawBits = 0;
-				rawBits |= ((int32_t)server->recvBuffer[6]) << 24; 	// byte 3 of ID
-				rawBits |= ((int32_t)server->recvBuffer[7]) << 16; 	// byte 2 of ID
-				rawBits |= ((int32_t)server->recvBuffer[8]) << 8;	// byte 1 of ID
-				rawBits |= ((int32_t)server->recvBuffer[9]);		// byte 0 of ID
-				
-				int botID = ntohl(rawBits);
+			
+			LOG(LOG_LEVEL_INFO, "Player join response received from server. Assigned ID: %d\n", botID);
 				
-				fprintf(stdout, "Player join response received from server. Assigned ID: %d\n", botID);
-					
-				// Initialize the bot
-				bot = BotFactory::createBot(botAIType, PLAYER_LIMIT, botID);
-			}
+			// Initialize the bot
+			bot = BotFactory::createBotOfType(botTypeIndex, botID);
 			break;
 		}
 		case SERVER_MAP_UPDATE:
 		{
-			// At least 8 bytes are expected for map update
-			if (numBytes < 8)
+			uint16_t numPlayers;
+			
+			// The frame must hold a record for each player
+			if (!ServerMapUpdateMessage::decode(frame, numBytes, numPlayers) || !ServerMapUpdateMessage::hasRecords(numBytes, numPlayers))
 			{
-				fprintf(stderr, "Wrong number of bytes received in map update message: %u\n", numBytes);
-				for (int i = 0; i < (int)numBytes; i++)
-				{
-					fprintf(stdout, "Byte %d: %d\n", i, server->recvBuffer[i]);
-				}
+				LOG(LOG_LEVEL_ERROR, "Wrong number of bytes received in map update message: %u\n", numBytes);
+				dumpFrame(frame, numBytes);
 				res = -1;
+				break;
 			}
-			else
-			{
-				// Read the number of players in the map
-				uint16_t rawNumPlayers = 0;
-				rawNumPlayers |= ((uint16_t)server->recvBuffer[6]) << 8; 	// byte 1 of numPlayers
-				rawNumPlayers |= ((uint16_t)server->recvBuffer[7]); 		// byte 0 of numPlayers
-				
-				int16_t numPlayers = (int16_t)(ntohs(rawNumPlayers));
-				
-				int index = 8;
-				
-				// Iterate through each player on map and read their info
-				for (int32_t i = 0; i < (int32_t)numPlayers; i++)
-				{
-					// Read the player's ID		
-					uint32_t rawID = 0;
-					rawID |= ((uint32_t)server->recvBuffer[index]) << 24; 		// byte 3 of ID
-					rawID |= ((uint32_t)server->recvBuffer[index + 1]) << 16; 	// byte 2 of ID
-					rawID |= ((uint32_t)server->recvBuffer[index + 2]) << 8;	// byte 1 of ID
-					rawID |= ((uint32_t)server->recvBuffer[index + 3]);			// byte 0 of ID
-					
-					int32_t playerID = (int32_t)ntohl(rawID);
-					
-					uint32_t rawX = 0;
-					uint32_t rawY = 0;
-					uint32_t rawZ = 0;
-					
-					float x = 0;
-					float y = 0;
-					float z = 0;
-					
-					// Read the player's x coordinate
-					rawX |= ((uint32_t)server->recvBuffer[index + 4]) << 24; 	// byte 3 of x
-					rawX |= ((uint32_t)server->recvBuffer[index + 5]) << 16; 	// byte 2 of x
-					rawX |= ((uint32_t)server->recvBuffer[index + 6]) << 8;		// byte 1 of x
-					rawX |= ((uint32_t)server->recvBuffer[index + 7]);			// byte 0 of x				
-					uint32_t binaryX = ntohl(rawX);
-					memcpy(&x, &binaryX, sizeof(float));
-
-					// Read the player's y coordinate
-					rawY |= ((uint32_t)server->recvBuffer[index + 8]) << 24; 	// byte 3 of y
-					rawY |= ((uint32_t)server->recvBuffer[index + 9]) << 16; 	// byte 2 of y
-					rawY |= ((uint32_t)server->recvBuffer[index + 10]) << 8;	// byte 1 of y
-					rawY |= ((uint32_t)server->recvBuffer[index + 11]);			// byte 0 of y					
-					uint32_t binaryY = ntohl(rawY);
-					memcpy(&y, &binaryY, sizeof(float));
-					
-					// Read the player's z coordinate
-					rawZ |= ((uint32_t)server->recvBuffer[index + 12]) << 24; 	// byte 3 of z
-					rawZ |= ((uint32_t)server->recvBuffer[index + 13]) << 16; 	// byte 2 of z
-					rawZ |= ((uint32_t)server->recvBuffer[index + 14]) << 8;	// byte 1 of z
-					rawZ |= ((uint32_t)server->recvBuffer[index + 15]);			// byte 0 of z					
-					uint32_t binaryZ = ntohl(rawZ);
-					memcpy(&z, &binaryZ, sizeof(float));
-					
-					// Update the bot about the player's location
-					if (bot != NULL)
-					{
-						bot->playerLocationUpdat(playerID, x, y, z);
-					}			
-					
-					// Move the index to the next 16 bytes block
-					index += 16;
-				}
-			}
+			
+			if (bot == NULL) break;
+			
+			// The update is decoded only once for all the clients of the process, and the bot reads the shared snapshot
+			bool isShared;
+			
+			lastWorld = world->publish(ServerMapUpdateMessage::getRecord(frame, 0), numPlayers, Bot::getTime(), lastWorld, isShared);
+			loop->getMetrics().countMapUpdate(isShared);
+			
+			BotEvent event = { BOT_EVENT_WORLD, 0, 0, 0, 0, lastWorld, decodeTime };
+			
+			deliverBotEvent(event);
+			recordMapUpdate();
 			break;
 		}
 		case PLAYER_SPAWN_WITH_ID:
 		{
-			// 22 bytes are expected in player spawn with ID message from server
-			if (numBytes != 22)
+			int32_t playerID;
+			float x, y, z;
+			
+			if (!PlayerSpawnWithIDMessage::decode(frame, numBytes, playerID, x, y, z))
 			{
-				fprintf(stderr, "Wrong number of bytes received in player spawn with ID message: %u\n", numBytes);
-				for (int i = 0; i < (int)numBytes; i++)
-				{
-					fprintf(stdout, "Byte %d: %d\n", i, server->recvBuffer[i]);
-				}
+				LOG(LOG_LEVEL_ERROR, "Wrong number of bytes received in player spawn with ID message: %u\n", numBytes);
+				dumpFrame(frame, numBytes);
 				res = -1;
+				break;
 			}
-			else
+			
+			// Inform the bot of the new spawn
+			if (bot != NULL)
 			{
-				// Read the player's ID
-	
-				uint32_t rawID = 0;
-				rawID |= ((uint32_t)server->recvBuffer[6]) << 24; 		// byte 3 of ID
-				rawID |= ((uint32_t)server->recvBuffer[7]) << 16; 	// byte 2 of ID
-				rawID |= ((uint32_t)server->recvBuffer[8]) << 8;	// byte 1 of ID
-				rawID |= ((uint32_t)server->recvBuffer[9]);			// byte 0 of ID
-					
-				int32_t playerID = (int32_t)ntohl(rawID);
-				
-				uint32_t rawX = 0;
-				uint32_t rawY = 0;
-				uint32_t rawZ = 0;
-				
-				float x = 0;
-				float y = 0;
-				float z = 0;
-				
-				// Read the player's x coordinate
-				rawX |= ((uint32_t)server->recvBuffer[10]) << 24; 	// byte 3 of x
-				rawX |= ((uint32_t)server->recvBuffer[11]) << 16; 	// byte 2 of x
-				rawX |= ((uint32_t)server->recvBuffer[12]) << 8;		// byte 1 of x
-				rawX |= ((uint32_t)server->recvBuffer[13]);			// byte 0 of x				
-				uint32_t binaryX = ntohl(rawX);
-				memcpy(&x, &binaryX, sizeof(float));
-
-				// Read the player's y coordinate
-				rawY |= ((uint32_t)server->recvBuffer[14]) << 24; 	// byte 3 of y
-				rawY |= ((uint32_t)server->recvBuffer[15]) << 16; 	// byte 2 of y
-				rawY |= ((uint32_t)server->recvBuffer[16]) << 8;	// byte 1 of y
-				rawY |= ((uint32_t)server->recvBuffer[17]);			// byte 0 of y					
-				uint32_t binaryY = ntohl(rawY);
-				memcpy(&y, &binaryY, sizeof(float));
-				
-				// Read the player's z coordinate
-				rawZ |= ((uint32_t)server->recvBuffer[18]) << 24; 	// byte 3 of z
-				rawZ |= ((uint32_t)server->recvBuffer[19]) << 16; 	// byte 2 of z
-				rawZ |= ((uint32_t)server->recvBuffer[20]) << 8;	// byte 1 of z
-				rawZ |= ((uint32_t)server->recvBuffer[21]);			// byte 0 of z					
-				uint32_t binaryZ = ntohl(rawZ);
-				memcpy(&z, &binaryZ, sizeof(float));
-				
-				// Inform the bot of the new spawn
-				if (bot != NULL)
-				{
-					bot->playerSpawnUpdate(playerID, x, y, z);
-				}
+				BotEvent event = { BOT_EVENT_SPAWN, playerID, x, y, z, NULL, decodeTime };
 				
-				fprintf(stdout, "Player %d spawned at {%.2f, %.2f, %.2f}\n", playerID, x, y, z);
+				deliverBotEvent(event);
 			}
+			
+			LOG(LOG_LEVEL_DEBUG, "Player %d spawned at {%.2f, %.2f, %.2f}\n", playerID, x, y, z);
 			break;
 		}
 		case ANNIHILATION_RESULTS:
 		{
-			// At least 12 bytes are expected from annihilation results message
-			if (numBytes < 12)
+			int32_t killerID;
+			uint16_t numKills;
+			
+			// The frame must hold the ID of each killed player
+			if (!AnnihilationResultsMessage::decode(frame, numBytes, killerID, numKills) || !AnnihilationResultsMessage::hasRecords(numBytes, numKills))
 			{
-				fprintf(stderr, "Wrong number of bytes received in annihilation result message: %u\n", numBytes);
-				for (int i = 0; i < (int)numBytes; i++)
-				{
-					fprintf(stdout, "Byte %d: %d\n", i, server->recvBuffer[i]);
-				}
+				LOG(LOG_LEVEL_ERROR, "Wrong number of bytes received in annihilation result message: %u\n", numBytes);
+				dumpFrame(frame, numBytes);
 				res = -1;
+				break;
 			}
-			else
+			
+			// Inform the bot that a player is killed
+			if (bot != NULL)
 			{
-				// Read the ID of self-annihilated player		
-				uint32_t rawID = 0;
-				rawID |= ((uint32_t)server->recvBuffer[6]) << 24; 		// byte 3 of ID
-				rawID |= ((uint32_t)server->recvBuffer[7]) << 16; 	// byte 2 of ID
-				rawID |= ((uint32_t)server->recvBuffer[8]) << 8;	// byte 1 of ID
-				rawID |= ((uint32_t)server->recvBuffer[9]);			// byte 0 of ID
-					
-				int32_t killerID = (int32_t)ntohl(rawID);
-				
-				// Inform the bot that a player is killed
-				if (bot != NULL)
-				{
-					bot->playerKilledUpdate(killerID);
-				}
-				
-				fprintf(stdout, "Player %d self-annihilated!!!\n", killerID);
-				
-				// Read the number of player killed
-				uint16_t rawNumKills = 0;
-				rawNumKills |= ((uint16_t)server->recvBuffer[10]) << 8; 	// byte 1 of numKills
-				rawNumKills |= ((uint16_t)server->recvBuffer[11]); 		// byte 0 of numKills
+				BotEvent event = { BOT_EVENT_KILLED, killerID, 0, 0, 0, NULL, decodeTime };
 				
-				int16_t numKills = (int16_t)(ntohs(rawNumKills));
+				deliverBotEvent(event);
+			}
+			
+			LOG(LOG_LEVEL_DEBUG, "Player %d self-annihilated!!!\n", killerID);
+			
+			// Update the score of the player if the player is the one causing the explosion
+			if (bot != NULL && bot->getID() == killerID)
+			{
+				BotEvent event = { BOT_EVENT_SCORE, numKills, 0, 0, 0, NULL, decodeTime };
 				
-				// Update the score of the player if the player is the one causing the explosion
-				if (bot != NULL && bot->getID() == killerID)
-				{
-					bot->incrementScore(numKills); 
-				}
+				deliverBotEvent(event);
+			}
+			
+			// Read the data of each killed player
+			for (uint32_t i = 0; i < numKills; i++)
+			{
+				int32_t playerID;
 				
-				int index = 12;
+				AnnihilationResultsMessage::decodeRecord(frame, i, playerID);
 				
-				// Read the data of each killed player
-				for (int32_t i = 0; i < (int32_t)numKills; i++)
+				// Inform the bot that the player is killed
+				if (bot != NULL)
 				{
-					rawID = 0;
-					rawID |= ((uint32_t)server->recvBuffer[index]) << 24; 		// byte 3 of ID
-					rawID |= ((uint32_t)server->recvBuffer[index + 1]) << 16; 	// byte 2 of ID
-					rawID |= ((uint32_t)server->recvBuffer[index + 2]) << 8;	// byte 1 of ID
-					rawID |= ((uint32_t)server->recvBuffer[index + 3]);			// byte 0 of ID
+					BotEvent event = { BOT_EVENT_KILLED, playerID, 0, 0, 0, NULL, decodeTime };
 					
-					int32_t playerID = (int32_t)ntohl(rawID);
-					
-					// Inform the bot that the player is killed
-					if (bot != NULL)
-					{
-						bot->playerKilledUpdate(playerID);
-					}
-					
-					// If the killed player is this bot, and this bot is a punisher bot
-					// set the killer bot as the target
-					if (bot != NULL && bot->getID() == playerID)
-					{	
-						bot->setKiller(killerID);
-					}
+					deliverBotEvent(event);
+				}
 				
-					fprintf(stdout, "Player %d blown to pieces!!!\n", playerID);
+				// If the killed player is this bot, and this bot is a punisher bot
+				// set the killer bot as the target
+				if (bot != NULL && bot->getID() == playerID)
+				{	
+					BotEvent event = { BOT_EVENT_KILLER, killerID, 0, 0, 0, NULL, decodeTime };
 					
-					// Move the index to the next 4 bytes block
-					index += 4;
+					deliverBotEvent(event);
 				}
-				
-				if (bot != NULL)
-				{
-					fprintf(stdout, "Current player score: %d\n", bot->getScore());
-				}		
+			
+				LOG(LOG_LEVEL_DEBUG, "Player %d blown to pieces!!!\n", playerID);
+			}
+			
+			if (bot != NULL)
+			{
+				LOG(LOG_LEVEL_DEBUG, "Current player score: %d\n", bot->getScore());
 			}
 			break;
 		}
 		default:
 		{
-			fprintf(stderr, "Wrong message code in player message\n");
+			LOG(LOG_LEVEL_ERROR, "Wrong message code in player message\n");
 			res = -1;
 			break;
 		}
@@ -583,192 +929,81 @@ int PlayerClient::processServerMessage()
 }
 
 
-int PlayerClient::sendPlayerSpawnMessage()
-{	
-	uint32_t numBytes = 18;
-	uint32_t convertedBytes = htonl(numBytes);
+void PlayerClient::dumpFrame(const uint8_t* frame, uint32_t numBytes)
+{
+	if (Log::getLevel() < LOG_LEVEL_DEBUG) return;
 	
-	uint32_t binaryX;
-	uint32_t binaryY;
-	uint32_t binaryZ;
+	static const char digits[] = "0123456789abcdef";
 	
-	float x = bot->getX();
-	float y = bot->getY();
-	float z = bot->getZ();
+	char hex[2 * FRAME_DUMP_BYTES + 1];
+	uint32_t numDumped = (numBytes < FRAME_DUMP_BYTES) ? numBytes : FRAME_DUMP_BYTES;
 	
-	// Copy the binary bits in the float coordinates into uint32_t variables
-	// This must be done instead of casting because
-	// casting the float values to uint32_t is equivalent to rounding
-	memcpy(&binaryX, &x, sizeof(float));
-	memcpy(&binaryY, &y, sizeof(float));
-	memcpy(&binaryZ, &z, sizeof(float));
-
-	uint32_t convertedX = htonl(binaryX);
-	uint32_t convertedY = htonl(binaryY);
-	uint32_t convertedZ = htonl(binaryZ);
-	
-	server->sendBuffer[0] = GET_BYTE_3(convertedBytes);
-	server->sendBuffer[1] = GET_BYTE_2(convertedBytes);
-	server->sendBuffer[2] = GET_BYTE_1(convertedBytes);
-	server->sendBuffer[3] = GET_BYTE_0(convertedBytes);
-	server->sendBuffer[4] = VERSION_NUM;
-	server->sendBuffer[5] = PLAYER_SPAWN;
-	server->sendBuffer[6] = GET_BYTE_3(convertedX);	// byte 3 of x
-	server->sendBuffer[7] = GET_BYTE_2(convertedX);	// byte 2 of x
-	server->sendBuffer[8] = GET_BYTE_1(convertedX);	// byte 1 of x
-	server->sendBuffer[9] = GET_BYTE_0(convertedX);	// byte 0 of x
-	server->sendBuffer[10] = GET_BYTE_3(convertedY);// byte 3 of y
-	server->sendBuffer[11] = GET_BYTE_2(convertedY);// byte 2 of y
-	server->sendBuffer[12] = GET_BYTE_1(convertedY);// byte 1 of y
-	server->sendBuffer[13] = GET_BYTE_0(convertedY);// byte 0 of y
-	server->sendBuffer[14] = GET_BYTE_3(convertedZ);// byte 3 of z
-	server->sendBuffer[15] = GET_BYTE_2(convertedZ);// byte 2 of z
-	server->sendBuffer[16] = GET_BYTE_1(convertedZ);// byte 1 of z
-	server->sendBuffer[17] = GET_BYTE_0(convertedZ);// byte 0 of z
-	
-	ssize_t bytes = -1;
-	
-	if (FD_ISSET(server->sockfd, &writeSet))
-	{
-		bytes = send(server->sockfd, server->sendBuffer, (int)numBytes, 0);
-	}
-	
-	// If an error occurred, retry 3 times
-	int count = 3;
-	while (bytes != numBytes && count > 0)
+	for (uint32_t i = 0; i < numDumped; i++)
 	{
-		if (FD_ISSET(server->sockfd, &writeSet))
-		{
-			bytes = send(server->sockfd, server->sendBuffer, (int)numBytes, 0);
-		}
-		count--;
+		hex[2 * i] = digits[frame[i] >> 4];
+		hex[2 * i + 1] = digits[frame[i] & 0xF];
 	}
 	
-	if (bytes == numBytes)
+	hex[2 * numDumped] = 0;
+	
+	LOG(LOG_LEVEL_DEBUG, "Frame of %u bytes: %s%s\n", numBytes, hex, (numDumped < numBytes) ? "..." : "");
+}
+
+
+template <typename Message, typename... Args>
+int PlayerClient::queueMessage(Args... args)
+{
+	// Encode the message directly into the outbound queue
+	uint8_t* frame = outbound.reserve(Message::TYPE);
+	
+	if (frame == NULL)
 	{
-		fprintf(stdout, "Player spawned at {%.2f, %.2f, %.2f}\n", x, y ,z);
-		return 0;
+		LOG(LOG_LEVEL_WARNING, "Outbound queue is full, message dropped\n");
+		return -1;
 	}
 	
-	fprintf(stderr, "Failed to send player spawn message\n");
-	return -1;
+	uint32_t length = Message::encode(frame, args...);
+	
+	// The frame is written to the socket with the other queued frames at the end of the event
+	outbound.commit(length);
 	
-	// More sophisticated error handling is needed in a real game
+	return 0;
 }
 
 
-int PlayerClient::sendPlayerMoveMessage()
-{	
-	uint32_t numBytes = 18;
-	uint32_t convertedBytes = htonl(numBytes);
-	
-	uint32_t binaryX;
-	uint32_t binaryY;
-	uint32_t binaryZ;
-			
+int PlayerClient::sendPlayerSpawnMessage()
+{
 	float x = bot->getX();
 	float y = bot->getY();
 	float z = bot->getZ();
 	
-	// Copy the binary bits in the float coordinates into uint32_t variables
-	// This must be done instead of casting because
-	// casting the float values to uint32_t is equivalent to rounding
-	memcpy(&binaryX, &x, sizeof(float));
-	memcpy(&binaryY, &y, sizeof(float));
-	memcpy(&binaryZ, &z, sizeof(float));
-
-	uint32_t convertedX = htonl(binaryX);
-	uint32_t convertedY = htonl(binaryY);
-	uint32_t convertedZ = htonl(binaryZ);
-	
-	server->sendBuffer[0] = GET_BYTE_3(convertedBytes);
-	server->sendBuffer[1] = GET_BYTE_2(convertedBytes);
-	server->sendBuffer[2] = GET_BYTE_1(convertedBytes);
-	server->sendBuffer[3] = GET_BYTE_0(convertedBytes);
-	server->sendBuffer[4] = VERSION_NUM;
-	server->sendBuffer[5] = PLAYER_MOVE;
-	server->sendBuffer[6] = GET_BYTE_3(convertedX);	// byte 3 of x
-	server->sendBuffer[7] = GET_BYTE_2(convertedX);	// byte 2 of x
-	server->sendBuffer[8] = GET_BYTE_1(convertedX);	// byte 1 of x
-	server->sendBuffer[9] = GET_BYTE_0(convertedX);	// byte 0 of x
-	server->sendBuffer[10] = GET_BYTE_3(convertedY);// byte 3 of y
-	server->sendBuffer[11] = GET_BYTE_2(convertedY);// byte 2 of y
-	server->sendBuffer[12] = GET_BYTE_1(convertedY);// byte 1 of y
-	server->sendBuffer[13] = GET_BYTE_0(convertedY);// byte 0 of y
-	server->sendBuffer[14] = GET_BYTE_3(convertedZ);// byte 3 of z
-	server->sendBuffer[15] = GET_BYTE_2(convertedZ);// byte 2 of z
-	server->sendBuffer[16] = GET_BYTE_1(convertedZ);// byte 1 of z
-	server->sendBuffer[17] = GET_BYTE_0(convertedZ);// byte 0 of z
-	
-	ssize_t bytes = -1;
-	
-	if (FD_ISSET(server->sockfd, &writeSet))
-	{
-		bytes = send(server->sockfd, server->sendBuffer, (int)numBytes, 0);
-	}
-	
-	// If an error occurred, retry 3 times
-	int count = 3;
-	while (bytes != numBytes && count > 0)
-	{
-		if (FD_ISSET(server->sockfd, &writeSet))
-		{
-			bytes = send(server->sockfd, server->sendBuffer, (int)numBytes, 0);
-		}
-		count--;
-	}
+	if (queueMessage<PlayerSpawnMessage>(x, y, z) == -1) return -1;
 	
-	if (bytes == numBytes)
-	{
-		fprintf(stdout, "Player moved to {%.2f, %.2f, %.2f}\n", x, y ,z);
-		return 0;
-	}
-	
-	fprintf(stderr, "Failed to send player move message\n");
-	return -1;
+	LOG(LOG_LEVEL_DEBUG, "Player spawned at {%.2f, %.2f, %.2f}\n", x, y ,z);
 	
-	// More sophisticated error handling is needed in a real game
+	return 0;
 }
 
 
-int PlayerClient::sendPlayerSelfAnnihilateMessage()
+int PlayerClient::sendPlayerMoveMessage()
 {
-	uint32_t numBytes = 6;
-	uint32_t convertedBytes = htonl(numBytes);
-	
-	server->sendBuffer[0] = GET_BYTE_3(convertedBytes);
-	server->sendBuffer[1] = GET_BYTE_2(convertedBytes);
-	server->sendBuffer[2] = GET_BYTE_1(convertedBytes);
-	server->sendBuffer[3] = GET_BYTE_0(convertedBytes);
-	server->sendBuffer[4] = VERSION_NUM;
-	server->sendBuffer[5] = PLAYER_SELF_ANNIHILATE;
+	float x = bot->getX();
+	float y = bot->getY();
+	float z = bot->getZ();
 	
-	ssize_t bytes = -1;
+	if (queueMessage<PlayerMoveMessage>(x, y, z) == -1) return -1;
 	
-	if (FD_ISSET(server->sockfd, &writeSet))
-	{
-		bytes = send(server->sockfd, server->sendBuffer, (int)numBytes, 0);
-	}
+	LOG(LOG_LEVEL_DEBUG, "Player moved to {%.2f, %.2f, %.2f}\n", x, y ,z);
 	
-	// If an error occurred, retry 3 times
-	int count = 3;
-	while (bytes != numBytes && count > 0)
-	{
-		if (FD_ISSET(server->sockfd, &writeSet))
-		{
-			bytes = send(server->sockfd, server->sendBuffer, (int)numBytes, 0);
-		}
-		count--;
-	}
-	
-	if (bytes == numBytes)
-	{
-		fprintf(stdout, "Player self-annihilated at {%.2f, %.2f, %.2f}!!!\n", bot->getX(), bot->getY(), bot->getZ());
-		return 0;
-	}
+	return 0;
+}
+
+
+int PlayerClient::sendPlayerSelfAnnihilateMessage()
+{
+	if (queueMessage<PlayerSelfAnnihilateMessage>() == -1) return -1;
 	
-	fprintf(stderr, "Failed to send player self-annihilate message. Num bytes sent: %ld\n", bytes);
-	return -1;
+	LOG(LOG_LEVEL_DEBUG, "Player self-annihilated at {%.2f, %.2f, %.2f}!!!\n", bot->getX(), bot->getY(), bot->getZ());
 	
-	// More sophisticated error handling is needed in a real game
+	return 0;
 }
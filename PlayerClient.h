@@ -24,7 +24,9 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -35,34 +37,53 @@
 #include <string.h>
 #include <ctime>
 #include "Bot.h"
+#include "EventLoop.h"
+#include "Protocol.h"
+#include "OutboundQueue.h"
+#include "SharedWorld.h"
+#include "BufferPool.h"
+#include "Log.h"
 #include "BotFactory.h"
 #include "DumbBot.h"
 #include "PunisherBot.h"
 
-#define VERSION_NUM					1
+#define BUFFER_SIZE 				1024	// initial size of the receive buffer
+#define RECV_BUFFER_SHRINK_SIZE		65536	// receive buffers larger than this are given back once the large frame is processed
+#define MAP_UPDATE_MILLISEC			50
 
-// Message code
-#define PLAYER_MOVE 				1
-#define PLAYER_SELF_ANNIHILATE 		2
-#define PLAYER_SPAWN 				3
-#define PLAYER_JOIN_RESPONSE 		4
-#define SERVER_MAP_UPDATE 			5
-#define PLAYER_SPAWN_WITH_ID 		6
-#define ANNIHILATION_RESULTS		7
+// Each new interval between map updates moves the estimate of the server's update period by 1/MAP_UPDATE_PERIOD_GAIN of the difference
+#define MAP_UPDATE_PERIOD_GAIN		8
 
-#define BUFFER_SIZE 				1024
-#define MAP_UPDATE_MILLISEC			50
-#define PLAYER_LIMIT				20
+// Hold back player moves while more than this number of bytes are waiting in the kernel send queue
+#define SEND_QUEUE_THROTTLE_BYTES	2048
 
-// Macros for extracting bytes
-#define GET_BYTE_3(x)	((x & 0xFF000000) >> 24)
-#define GET_BYTE_2(x)	((x & 0x00FF0000) >> 16)		
-#define GET_BYTE_1(x)	((x & 0x0000FF00) >> 8)
-#define GET_BYTE_0(x)	(x & 0x000000FF)
+// Number of bytes of an invalid frame that are logged, in hex, so that the dump fits in a single log record
+#define FRAME_DUMP_BYTES			32
 
 using namespace std;
 
 
+// Types of the server events that update the bot
+#define BOT_EVENT_WORLD				1	// map update
+#define BOT_EVENT_SPAWN				2	// player spawned
+#define BOT_EVENT_KILLED			3	// player killed
+#define BOT_EVENT_KILLER			4	// the bot was killed by the player
+#define BOT_EVENT_SCORE				5	// the bot killed some players
+
+
+// Server event for the bot
+// While the bot decides on a thread of the decision pool, the events are held back and applied once its action is back
+typedef struct
+{
+	int type;
+	int32_t playerID; // ID of the player, or number of players killed for BOT_EVENT_SCORE
+	float x, y, z; // spawn location for BOT_EVENT_SPAWN
+	shared_ptr<const WorldSnapshot> world; // snapshot of the map update for BOT_EVENT_WORLD
+	int64_t decodeTime; // monotonic time at which the frame of the event started being decoded, in nanoseconds
+	
+} BotEvent;
+
+
 // Struct writtent based on udp-client.c UDPClient
 typedef struct
 {
@@ -70,9 +91,17 @@ typedef struct
 	const char* hostName;
 	const char* portNum;
 	
-	// 4kB buffers
-	uint8_t recvBuffer[BUFFER_SIZE];
-	uint8_t sendBuffer[BUFFER_SIZE];
+	// Receive buffer from the buffer pool
+	// It starts with BUFFER_SIZE bytes and grows to hold frames of any length
+	uint8_t* recvBuffer;
+	uint32_t recvCapacity;
+	
+	// Number of bytes in the receive buffer that are not decoded yet
+	// These are the leading bytes of a frame split across several recv calls
+	uint32_t recvLength;
+	
+	// Set when the server closes the connection
+	bool isClosed;
 	
 	struct addrinfo info;
 	struct sockaddr addr;
@@ -86,16 +115,45 @@ class PlayerClient
 	private:
 		
 		TCPHost* server;
-		struct timeval timeout;
-		int maxfd;
 		
 		int botAIType;
+		int botTypeIndex; // index of the type of the bot in KnownBotTypes, used to call the bot without virtual dispatch
 		Bot* bot;
 		
-		fd_set masterSet;
-		fd_set readSet;
-		fd_set writeSet;
-		fd_set exceptSet;
+		EventLoop* loop; // the event loop that dispatches the events of this client
+		EventSource socketSource;
+		EventSource timerSource;
+		WheelTimer actionTimer; // timer of the event loop that expires when the bot is due to take its next action
+		uint32_t watchedEvents; // the epoll events currently watched on the server socket
+		bool isConnecting; // true while the non-blocking connect is in progress
+		
+		OutboundQueue outbound; // frames waiting to be written to the server socket
+		bool isThrottled; // true if the latest move is held back because the connection is congested
+		
+		SharedWorld* world; // world model shared with the other clients of the process, which decodes the map updates
+		shared_ptr<const WorldSnapshot> lastWorld; // snapshot of the last map update received, which tells the shared world how far behind the client is
+		
+		uint64_t skippedMapUpdates; // number of stale map updates skipped because a newer one was received in the same batch
+		
+		// Scheduling of the bot's actions on map updates
+		// When enabled, a bot whose cooldown is over acts right after a map update is applied, rather than when the cooldown ends,
+		// so that its decision is taken on the freshest world state
+		int64_t decisionSlack; // how long the bot may wait for a map update past the end of its cooldown, in nanoseconds (negative if disabled)
+		int64_t lastMapUpdateTime; // monotonic time at which the last map update was applied, in nanoseconds (negative if none yet)
+		int64_t mapUpdatePeriod; // estimate of the server's map update period, in nanoseconds
+		bool mapUpdateApplied; // set when a map update is applied by the current event
+		
+		// Decisions on the threads of a decision pool (see DecisionPool.h)
+		// The bot belongs to the worker from the request until the decision is back on the thread of the event loop
+		bool isDeciding; // true while the decision of the bot is in flight
+		int decidedAction; // action of the bot returned by the worker
+		PlayerClient* nextDecision; // next client of the same task of the decision pool
+		vector<BotEvent> deferredEvents; // events received while the bot is deciding, in order
+		
+		// Instrumentation, recorded in the metrics of the event loop (see Metrics.h)
+		int64_t recvTime; // monotonic time at which the oldest bytes in the receive buffer were received (negative if it is empty)
+		int64_t decisionNanos; // time taken by the decision of the worker
+		int64_t actionTime; // monotonic time at which the oldest action not fully written to the socket was queued (negative if none)
 		
 		
 		/*
@@ -130,9 +188,76 @@ class PlayerClient
 		 // Important: This function reads the message received in the buffer and update the bot
 		 // The function does not implement any bot AI logic
 		 // Bot AI logic is be implemented by the bot itself
+		 // The socket is drained until recv would block, so several concatenated frames are all processed
 		 int processServerMessage();
+		 
+		 // Resize the receive buffer to fit the frame at its beginning
+		 // The buffer grows if the frame is larger than the buffer, and goes back to its initial size after a large frame
+		 // Return 0 on success, -1 if the memory can't be allocated
+		 int fitRecvBuffer();
+		 
+		 // Decode all complete frames in the receive buffer
+		 // If the batch contains several map updates, only the latest one is applied
+		 // The bytes of an incomplete frame are kept at the beginning of the buffer for the next recv
+		 // Return 0 if sucess, -1 if any frame is invalid
+		 int processBufferedFrames();
+		 
+		 
+		 // Decode a single complete frame of numBytes bytes (including the header) and update the bot
+		 // Return 0 if sucess, -1 if error
+		 int processFrame(const uint8_t* frame, uint32_t numBytes);
 		
+		 // Complete the non-blocking connect once the socket becomes writable
+		 // Return 0 on success, -1 on failure
+		 int finishConnect();
+		 
+		 // Watch the server socket for writability only when there's something to write
+		 void updateWatchedEvents();
+		 
+		 // Determine if the kernel send queue holds more unacknowledged bytes than the throttle limit
+		 bool isSendQueueCongested();
+		 
+		 // Remove the client from its event loop after the connection is closed
+		 void disconnect();
+		 
+		 // Log the first bytes of an invalid frame
+		 void dumpFrame(const uint8_t* frame, uint32_t numBytes);
+		 
+		 // Encode a message of the given schema with the given fields into the outbound queue
+		 // Return 0 on success, -1 if the queue is full
+		 template <typename Message, typename... Args>
+		 int queueMessage(Args... args);
+		 
+		 // Let the bot take its next action and send the resulting message to the server
+		 // With a decision pool, the decision is handed to a worker, and the message is sent once it is back
+		 void performBotAction();
+		 
+		 // Send the message of an action taken by the bot
+		 void sendBotAction(int action);
+		 
+		 // Send the action decided by a worker, then apply the events held back meanwhile
+		 void completeBotAction();
+		 
+		 // Update the bot of a server event, or hold it back while the bot is deciding
+		 void deliverBotEvent(const BotEvent& event);
+		 
+		 void applyBotEvent(const BotEvent& event);
+		 
+		 // Arm the action timer at the time the bot's action cooldown is over
+		 // The timer is disarmed while there's no bot or while the outbound queue is full
+		 void armActionTimer();
+		 
+		 // Get the monotonic time at which the bot is due to act, in nanoseconds
+		 // When actions are scheduled on map updates and the next update is expected within the slack after the cooldown,
+		 // this is the latest time the bot waits for it
+		 // Return 0 if the bot can act right away
+		 int64_t getActionDeadline();
+		 
+		 // Record that a map update was applied, and refine the estimate of the server's update period
+		 void recordMapUpdate();
+		 
 		 // Send player spawn message to the server
+		 // The message is queued, and written to the socket at the end of the current event
 		 // Return 0 on success, -1 on failure
 		 int sendPlayerSpawnMessage();
 		 
@@ -155,11 +280,34 @@ class PlayerClient
 		// Create the player client
 		// The client is connected to server at server host name and server port num
 		// The AI type of the bot is specified by botAITYPE
-		PlayerClient(const char* serverHostName, const char* serverPortNum, int botAIType);
+		// The map updates are decoded by the world model shared by the clients of the process
+		// If decisionSlack is not negative, the bot acts right after map updates, waiting up to decisionSlack nanoseconds past its cooldown for one
+		PlayerClient(const char* serverHostName, const char* serverPortNum, int botAIType, SharedWorld* world, int64_t decisionSlack = -1);
 		
 		~PlayerClient();
 		
-		void run();
+		// Connect to the server and register the client with the event loop
+		// Return 0 on success (the connection may still be in progress), -1 on failure
+		int start(EventLoop* eventLoop);
+		
+		// Handle an event of the given source type (SOCKET_EVENT, TIMER_EVENT or DECISION_EVENT)
+		void handleEvent(int type, uint32_t events);
+		
+		// Let the bot decide on its next action, on a thread of the decision pool
+		// The client is then posted back to its event loop
+		void decideBotAction();
+		
+		// Let the bot decide on its next action, without posting the client back to its event loop
+		// Used by the event loop when the decision pool is full, and the loop then completes the action itself
+		void takeBotDecision();
+		
+		// Get the next client of the task of the decision pool that holds this client
+		PlayerClient* getNextDecision();
+		
+		void setNextDecision(PlayerClient* client);
+		
+		// Return true once the connection to the server is closed
+		bool isClosed();
 };
 
 #endif
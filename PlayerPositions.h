@@ -0,0 +1,62 @@
+#ifndef PLAYER_POSITIONS_H
+#define PLAYER_POSITIONS_H
+
+#include <stdint.h>
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ *
+ * Estimated positions of the players of a PlayerTable at the time of a query (dead reckoning).
+ *
+ * The table holds the positions observed in a map update and the velocity of each player.
+ * Rather than moving the players in the table, which is shared by many bots, each query extrapolates the positions it reads
+ * along the velocities, over the same elapsed time for all players, and clamps them to the arena.
+ * The spatial grid indexes the observed positions, so it widens its searches by maxDisplacement,
+ * the farthest any player can have moved from its observed position.
+ *
+ *********************************************************************************************************************************************/
+
+struct PlayerPositions
+{
+	const float* xs; // observed x coordinate of each slot
+	const float* ys; // observed y coordinate of each slot
+	const float* zs; // observed z coordinate of each slot
+	const float* vxs; // velocity of each slot along x, in units per second
+	const float* vys; // velocity of each slot along y, in units per second
+	const float* vzs; // velocity of each slot along z, in units per second
+	float elapsed; // time since the observation, in seconds
+	float maxDisplacement; // upper bound on the distance between the observed and estimated positions of any slot
+	
+	// Keep an estimated coordinate inside the arena
+	static inline float clampToArena(float v)
+	{
+		if (v < 0) return 0;
+		if (v > 1) return 1;
+		return v;
+	}
+	
+	// Get the estimated position of a slot
+	inline void get(int32_t slot, float& x, float& y, float& z) const
+	{
+		x = clampToArena(xs[slot] + vxs[slot] * elapsed);
+		y = clampToArena(ys[slot] + vys[slot] * elapsed);
+		z = clampToArena(zs[slot] + vzs[slot] * elapsed);
+	}
+	
+	// Get the squared distance between the estimated position of a slot and {x, y, z}
+	inline float getDistanceSquared(int32_t slot, float x, float y, float z) const
+	{
+		float px, py, pz;
+		get(slot, px, py, pz);
+		
+		float dx = px - x;
+		float dy = py - y;
+		float dz = pz - z;
+		
+		return dx * dx + dy * dy + dz * dz;
+	}
+};
+
+#endif
@@ -0,0 +1,324 @@
+#include "PlayerTable.h"
+#include "ProximityKernel.h"
+
+
+// Use the grid to find the players within a radius when the sphere overlaps at most this fraction of the cells
+// Above it, the SIMD scan of the whole table is faster than visiting the cells one by one
+#define GRID_QUERY_MAX_CELLS	(SPATIAL_GRID_CELLS * SPATIAL_GRID_CELLS * SPATIAL_GRID_CELLS / 4)
+
+
+PlayerTable::PlayerTable(uint32_t capacity)
+{
+	// Keep the load factor of the hash table under 1/2
+	uint32_t numBuckets = 16;
+	
+	while (numBuckets < capacity * 2) numBuckets <<= 1;
+	
+	buckets.assign(numBuckets, -1);
+	mask = numBuckets - 1;
+	
+	ids.reserve(capacity);
+	
+	numLive = 0;
+	observedTime = 0;
+	maxSpeed = 0;
+}
+
+
+uint32_t PlayerTable::findBucket(int32_t playerID) const
+{
+	// Fibonacci hashing spreads consecutive IDs over the buckets
+	uint32_t bucket = ((uint32_t)playerID * 2654435769u) & mask;
+	
+	// Linear probing
+	while (buckets[bucket] != -1 && ids[buckets[bucket]] != playerID)
+	{
+		bucket = (bucket + 1) & mask;
+	}
+	
+	return bucket;
+}
+
+
+void PlayerTable::grow()
+{
+	buckets.assign(buckets.size() * 2, -1);
+	mask = buckets.size() - 1;
+	
+	// Rehash all players
+	for (size_t slot = 0; slot < ids.size(); slot++)
+	{
+		buckets[findBucket(ids[slot])] = slot;
+	}
+}
+
+
+int32_t PlayerTable::find(int32_t playerID) const
+{
+	return buckets[findBucket(playerID)];
+}
+
+
+int32_t PlayerTable::insert(int32_t playerID)
+{
+	uint32_t bucket = findBucket(playerID);
+	
+	if (buckets[bucket] != -1) return buckets[bucket];
+	
+	int32_t slot = ids.size();
+	
+	ids.push_back(playerID);
+	
+	// Start a new word of the bitmaps every 64 slots
+	// The coordinate arrays grow by the same 64 slots, so that the proximity kernel always works on whole words
+	if ((slot & 63) == 0)
+	{
+		aliveBits.push_back(0);
+		
+		xs.resize(slot + 64, 0);
+		ys.resize(slot + 64, 0);
+		zs.resize(slot + 64, 0);
+		vxs.resize(slot + 64, 0);
+		vys.resize(slot + 64, 0);
+		vzs.resize(slot + 64, 0);
+	}
+	
+	changeTimes.push_back(0);
+	
+	buckets[bucket] = slot;
+	
+	if (ids.size() * 2 > buckets.size()) grow();
+	
+	return slot;
+}
+
+
+int32_t PlayerTable::getID(int32_t slot) const
+{
+	return ids[slot];
+}
+
+
+float PlayerTable::getX(int32_t slot) const
+{
+	return xs[slot];
+}
+
+
+float PlayerTable::getY(int32_t slot) const
+{
+	return ys[slot];
+}
+
+
+float PlayerTable::getZ(int32_t slot) const
+{
+	return zs[slot];
+}
+
+
+void PlayerTable::setPosition(int32_t slot, float x, float y, float z)
+{
+	xs[slot] = x;
+	ys[slot] = y;
+	zs[slot] = z;
+	
+	if (isAlive(slot)) grid.move(slot, x, y, z);
+}
+
+
+float PlayerTable::getVX(int32_t slot) const
+{
+	return vxs[slot];
+}
+
+
+float PlayerTable::getVY(int32_t slot) const
+{
+	return vys[slot];
+}
+
+
+float PlayerTable::getVZ(int32_t slot) const
+{
+	return vzs[slot];
+}
+
+
+int64_t PlayerTable::getChangeTime(int32_t slot) const
+{
+	return changeTimes[slot];
+}
+
+
+void PlayerTable::setMotion(int32_t slot, float vx, float vy, float vz, int64_t changeTime)
+{
+	vxs[slot] = vx;
+	vys[slot] = vy;
+	vzs[slot] = vz;
+	changeTimes[slot] = changeTime;
+	
+	float speed = sqrt(vx * vx + vy * vy + vz * vz);
+	
+	if (speed > maxSpeed) maxSpeed = speed;
+}
+
+
+int64_t PlayerTable::getObservedTime() const
+{
+	return observedTime;
+}
+
+
+void PlayerTable::setObservedTime(int64_t time)
+{
+	observedTime = time;
+}
+
+
+PlayerPositions PlayerTable::getPositions(int64_t time) const
+{
+	int64_t elapsed = time - observedTime;
+	
+	if (elapsed < 0) elapsed = 0;
+	if (elapsed > MAX_EXTRAPOLATION_NANOS) elapsed = MAX_EXTRAPOLATION_NANOS;
+	
+	PlayerPositions positions;
+	
+	positions.xs = xs.data();
+	positions.ys = ys.data();
+	positions.zs = zs.data();
+	positions.vxs = vxs.data();
+	positions.vys = vys.data();
+	positions.vzs = vzs.data();
+	positions.elapsed = nanosToSeconds(elapsed);
+	
+	// Leave some room for rounding errors
+	positions.maxDisplacement = maxSpeed * positions.elapsed * 1.001f + 1e-6f;
+	
+	return positions;
+}
+
+
+void PlayerTable::estimatePosition(int32_t slot, int64_t time, float& x, float& y, float& z) const
+{
+	getPositions(time).get(slot, x, y, z);
+}
+
+
+bool PlayerTable::isAlive(int32_t slot) const
+{
+	return (aliveBits[slot >> 6] >> (slot & 63)) & 1;
+}
+
+
+void PlayerTable::setAlive(int32_t slot, bool isAlive)
+{
+	uint64_t bit = (uint64_t)1 << (slot & 63);
+	uint64_t& word = aliveBits[slot >> 6];
+	
+	if (((word & bit) != 0) == isAlive) return;
+	
+	if (isAlive)
+	{
+		word |= bit;
+		numLive++;
+		grid.insert(slot, xs[slot], ys[slot], zs[slot]);
+	}
+	else
+	{
+		word &= ~bit;
+		numLive--;
+		grid.remove(slot);
+	}
+}
+
+
+uint32_t PlayerTable::getNumLive() const
+{
+	return numLive;
+}
+
+
+int32_t PlayerTable::nextLive(int32_t slot) const
+{
+	return nextHit(aliveBits, slot);
+}
+
+
+uint32_t PlayerTable::findInRadius(float x, float y, float z, float radius, int64_t time, const vector<int32_t>& excluded, vector<uint64_t>& hits) const
+{
+	hits.resize(aliveBits.size());
+	
+	if (aliveBits.empty()) return 0;
+	
+	PlayerPositions positions = getPositions(time);
+	uint32_t numHits;
+	
+	if (SpatialGrid::countCellsInRadius(x, y, z, radius + positions.maxDisplacement) <= GRID_QUERY_MAX_CELLS)
+	{
+		hits.assign(aliveBits.size(), 0);
+		numHits = grid.findInRadius(positions, x, y, z, radius, hits.data());
+	}
+	else
+	{
+		numHits = ProximityKernel::findInRadius(positions, aliveBits.data(), aliveBits.size(), x, y, z, radius * radius, hits.data());
+	}
+	
+	// Take out the excluded slots that were found
+	for (size_t i = 0; i < excluded.size(); i++)
+	{
+		int32_t slot = excluded[i];
+		uint64_t bit = (uint64_t)1 << (slot & 63);
+		
+		if ((size_t)(slot >> 6) < hits.size() && (hits[slot >> 6] & bit) != 0)
+		{
+			hits[slot >> 6] &= ~bit;
+			numHits--;
+		}
+	}
+	
+	return numHits;
+}
+
+
+int32_t PlayerTable::findAnyInRadius(float x, float y, float z, float radius, int64_t time, const vector<int32_t>& excluded) const
+{
+	return grid.findAnyInRadius(getPositions(time), excluded, x, y, z, radius);
+}
+
+
+int32_t PlayerTable::findNearest(float x, float y, float z, int64_t time, const vector<int32_t>& excluded) const
+{
+	return grid.findNearest(getPositions(time), excluded, x, y, z);
+}
+
+
+int32_t PlayerTable::nextHit(const vector<uint64_t>& hits, int32_t slot)
+{
+	if (slot < 0) slot = 0;
+	
+	size_t index = slot >> 6;
+	
+	if (index >= hits.size()) return -1;
+	
+	// Ignore the slots before the given slot in its word
+	uint64_t word = hits[index] & (~(uint64_t)0 << (slot & 63));
+	
+	while (word == 0)
+	{
+		index++;
+		
+		if (index >= hits.size()) return -1;
+		
+		word = hits[index];
+	}
+	
+	return (index << 6) + __builtin_ctzll(word);
+}
+
+
+uint32_t PlayerTable::size() const
+{
+	return ids.size();
+}
@@ -0,0 +1,158 @@
+#ifndef PLAYER_TABLE_H
+#define PLAYER_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+#include <cmath>
+#include "SpatialGrid.h"
+#include "Timing.h"
+
+
+// Maximum time over which a position is extrapolated from the last observation, in nanoseconds
+// Two map update periods: past that, the player has most likely changed direction or stopped
+#define MAX_EXTRAPOLATION_NANOS		(100 * NANOS_PER_MILLISECOND)
+
+// Observations closer in time than this are too close to estimate a velocity, in nanoseconds
+#define MIN_VELOCITY_INTERVAL_NANOS	NANOS_PER_MILLISECOND
+
+// Time without a change of position after which a player is considered stopped, in nanoseconds
+// A moving player changes position once per action cooldown (1 second, see Bot.h), so two cooldowns without a change mean it has stopped
+#define STOPPED_VELOCITY_NANOS		(2 * NANOS_PER_SECOND)
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ * 
+ * Table of the players in the arena, indexed by the IDs assigned by the server.
+ * 
+ * The players are stored in slots, and an open-addressing hash table maps each player ID to its slot.
+ * IDs can be any 32-bit value, and the table grows as new players appear.
+ * Slots are never removed, so a slot index stays valid for the lifetime of the table.
+ * 
+ * The table is laid out as a structure of arrays: the x, y and z coordinates of all players are stored in contiguous arrays,
+ * and whether each player is alive is stored in a bitmap.
+ * Scans over the players, such as finding the players within a radius, only touch the arrays they need,
+ * and can skip 64 dead players at a time.
+ * The live players are also indexed by a uniform grid over the arena (see SpatialGrid.h), kept up to date as they spawn, move and die.
+ * 
+ * A table holds the positions of the players observed in a map update, along with the velocity of each player
+ * and the time at which its position last changed (see SharedWorld.h).
+ * Once built, a table is only read, so that it can be shared by all the bots of a process.
+ * The queries take the time of the decision they serve, and test the positions estimated at that time (dead reckoning),
+ * so that the decisions are not based on positions that are up to a map update period old.
+ * They also take a list of slots to ignore, such as the bot itself or the players it knows to have died since the map update.
+ * The coordinate arrays are padded to a multiple of 64 slots, so that they can be processed a whole bitmap word at a time (see ProximityKernel.h).
+ * 
+ *********************************************************************************************************************************************/
+
+class PlayerTable
+{
+	private:
+	
+		vector<int32_t> ids; // ID of the player of each slot
+		vector<float> xs; // observed x coordinate of the player of each slot
+		vector<float> ys; // observed y coordinate of the player of each slot
+		vector<float> zs; // observed z coordinate of the player of each slot
+		vector<float> vxs; // velocity along x of the player of each slot, in units per second
+		vector<float> vys; // velocity along y of the player of each slot, in units per second
+		vector<float> vzs; // velocity along z of the player of each slot, in units per second
+		vector<int64_t> changeTimes; // time at which the position of the player of each slot last changed, in monotonic nanoseconds
+		int64_t observedTime; // time at which the positions were observed, in monotonic nanoseconds
+		float maxSpeed; // highest speed of the players, which bounds how far they move from their cells in the grid
+		vector<uint64_t> aliveBits; // bit set for each slot whose player is alive
+		uint32_t numLive; // number of live players
+		SpatialGrid grid; // cells of the live players
+		
+		vector<int32_t> buckets; // slot of each hash bucket, or -1 if the bucket is empty
+		uint32_t mask; // number of buckets - 1
+		
+		// Get the bucket of the player ID, or the empty bucket where it should be inserted
+		uint32_t findBucket(int32_t playerID) const;
+		
+		// Double the number of buckets
+		void grow();
+		
+		// Get the arrays of the table and the time elapsed since the observation, to estimate the positions at the given time
+		PlayerPositions getPositions(int64_t time) const;
+		
+	public:
+	
+		// Create an empty table with room for the given number of players
+		PlayerTable(uint32_t capacity);
+		
+		// Get the slot of the player ID
+		// Return -1 if the player is not in the table
+		int32_t find(int32_t playerID) const;
+		
+		// Get the slot of the player ID, adding a new player that is not alive if needed
+		int32_t insert(int32_t playerID);
+		
+		// Get the ID of the player in a slot
+		int32_t getID(int32_t slot) const;
+		
+		// Get the observed position of the player in a slot
+		float getX(int32_t slot) const;
+		
+		float getY(int32_t slot) const;
+		
+		float getZ(int32_t slot) const;
+		
+		// Set the observed position of the player in a slot
+		void setPosition(int32_t slot, float x, float y, float z);
+		
+		// Get the velocity of the player in a slot
+		float getVX(int32_t slot) const;
+		
+		float getVY(int32_t slot) const;
+		
+		float getVZ(int32_t slot) const;
+		
+		// Get the time at which the position of the player in a slot last changed
+		int64_t getChangeTime(int32_t slot) const;
+		
+		// Set the velocity of the player in a slot, and the time at which its position last changed
+		void setMotion(int32_t slot, float vx, float vy, float vz, int64_t changeTime);
+		
+		// Get the time at which the positions were observed
+		int64_t getObservedTime() const;
+		
+		void setObservedTime(int64_t time);
+		
+		// Estimate the position of the player in a slot at the given time, from its observed position and velocity
+		void estimatePosition(int32_t slot, int64_t time, float& x, float& y, float& z) const;
+		
+		bool isAlive(int32_t slot) const;
+		
+		// Set whether the player in a slot is alive
+		void setAlive(int32_t slot, bool isAlive);
+		
+		// Get the number of live players
+		uint32_t getNumLive() const;
+		
+		// Get the first slot of a live player at or after the given slot
+		// Return -1 if there is none
+		int32_t nextLive(int32_t slot) const;
+		
+		// Find the live players, other than the excluded slots, within the radius of the point {x, y, z} at the given time
+		// The bit of each player found is set in hits, laid out like the alive bitmap
+		// Return the number of players found
+		uint32_t findInRadius(float x, float y, float z, float radius, int64_t time, const vector<int32_t>& excluded, vector<uint64_t>& hits) const;
+		
+		// Find any live player, other than the excluded slots, within the radius of the point {x, y, z} at the given time
+		// Return its slot, or -1 if there is none
+		int32_t findAnyInRadius(float x, float y, float z, float radius, int64_t time, const vector<int32_t>& excluded) const;
+		
+		// Find the live player, other than the excluded slots, nearest to the point {x, y, z} at the given time
+		// Return its slot, or -1 if there is none
+		int32_t findNearest(float x, float y, float z, int64_t time, const vector<int32_t>& excluded) const;
+		
+		// Get the first slot set in a hit mask at or after the given slot
+		// Return -1 if there is none
+		static int32_t nextHit(const vector<uint64_t>& hits, int32_t slot);
+		
+		// Get the number of players in the table
+		uint32_t size() const;
+};
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+
+/********************************************************************************************************************************************
+ *
+ * Message schemas of the game protocol.
+ *
+ * Every message is laid out as a list of fixed-size fields, described at compile time by a FieldList.
+ * Messages with a variable length (map updates and annihilation results) have a fixed part followed by a number of fixed-size records.
+ * The encoders and decoders are generated from the schemas, so each message has a single definition shared by all send and receive paths,
+ * and the offsets and sizes are all known at compile time.
+ *
+ * Byte order:
+ * The fields used to be assembled from their bytes in big-endian order and then converted again with ntohl/ntohs
+ * (or converted with htonl and then written from the most significant byte when sending).
+ * The two conversions cancel each other, so the bytes on the wire are in the sender's host byte order.
+ * The game server encodes its messages the same way, so the fields are copied as is to stay compatible with it.
+ *
+ *********************************************************************************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+
+#define VERSION_NUM					1
+
+// Message code
+#define PLAYER_MOVE 				1
+#define PLAYER_SELF_ANNIHILATE 		2
+#define PLAYER_SPAWN 				3
+#define PLAYER_JOIN_RESPONSE 		4
+#define SERVER_MAP_UPDATE 			5
+#define PLAYER_SPAWN_WITH_ID 		6
+#define ANNIHILATION_RESULTS		7
+
+// Every frame starts with the message length (4 bytes), the version (1 byte) and the message code (1 byte)
+#define FRAME_HEADER_SIZE			6
+
+using namespace std;
+
+
+// Read a field from the wire
+template <typename T>
+inline T loadField(const uint8_t* src)
+{
+	T value;
+	memcpy(&value, src, sizeof(T));
+	return value;
+}
+
+
+// Write a field to the wire
+template <typename T>
+inline void storeField(uint8_t* dst, T value)
+{
+	memcpy(dst, &value, sizeof(T));
+}
+
+
+// Read the length field in the header of a frame
+inline uint32_t readFrameLength(const uint8_t* frame)
+{
+	return loadField<uint32_t>(frame);
+}
+
+
+// A list of consecutive fields of the given types
+template <typename... Fields>
+struct FieldList;
+
+template <>
+struct FieldList<>
+{
+	static constexpr uint32_t SIZE = 0;
+
+	static inline void encode(uint8_t*) {}
+
+	static inline void decode(const uint8_t*) {}
+};
+
+template <typename Field, typename... Rest>
+struct FieldList<Field, Rest...>
+{
+	static constexpr uint32_t SIZE = sizeof(Field) + FieldList<Rest...>::SIZE;
+
+	static inline void encode(uint8_t* dst, Field field, Rest... rest)
+	{
+		storeField<Field>(dst, field);
+		FieldList<Rest...>::encode(dst + sizeof(Field), rest...);
+	}
+
+	static inline void decode(const uint8_t* src, Field& field, Rest&... rest)
+	{
+		field = loadField<Field>(src);
+		FieldList<Rest...>::decode(src + sizeof(Field), rest...);
+	}
+};
+
+
+// A message with the given code, made of the Fixed fields after the frame header,
+// followed by any number of records made of the Record fields
+template <uint8_t CODE, typename Fixed, typename Record = FieldList<> >
+struct MessageSchema
+{
+	static constexpr uint8_t TYPE = CODE;
+
+	// Number of bytes of the message without any record
+	static constexpr uint32_t FIXED_SIZE = FRAME_HEADER_SIZE + Fixed::SIZE;
+
+	static constexpr uint32_t RECORD_SIZE = Record::SIZE;
+	
+	typedef Record RecordLayout;
+
+	// Encode the message with its header into dst
+	// dst must have room for FIXED_SIZE bytes
+	// Return the number of bytes of the frame
+	template <typename... Args>
+	static inline uint32_t encode(uint8_t* dst, Args... args)
+	{
+		storeField<uint32_t>(dst, FIXED_SIZE);
+		dst[4] = VERSION_NUM;
+		dst[5] = CODE;
+		Fixed::encode(dst + FRAME_HEADER_SIZE, args...);
+
+		return FIXED_SIZE;
+	}
+
+	// Determine if a frame of numBytes bytes is long enough for the fixed fields
+	// Messages without records must have exactly the expected length
+	static inline bool isValidLength(uint32_t numBytes)
+	{
+		return (RECORD_SIZE == 0) ? (numBytes == FIXED_SIZE) : (numBytes >= FIXED_SIZE);
+	}
+
+	// Determine if a frame of numBytes bytes holds the given number of records
+	static inline bool hasRecords(uint32_t numBytes, uint32_t numRecords)
+	{
+		return numBytes >= FIXED_SIZE && (uint64_t)numRecords * RECORD_SIZE <= numBytes - FIXED_SIZE;
+	}
+
+	// Decode the fixed fields of a frame
+	// Return false if the frame is too short
+	template <typename... Args>
+	static inline bool decode(const uint8_t* frame, uint32_t numBytes, Args&... args)
+	{
+		if (!isValidLength(numBytes)) return false;
+
+		Fixed::decode(frame + FRAME_HEADER_SIZE, args...);
+		return true;
+	}
+
+	// Get a pointer to a record of a frame
+	// hasRecords() must be checked first
+	static inline const uint8_t* getRecord(const uint8_t* frame, uint32_t index)
+	{
+		return frame + FIXED_SIZE + index * RECORD_SIZE;
+	}
+
+	// Decode a record of a frame
+	// hasRecords() must be checked first
+	template <typename... Args>
+	static inline void decodeRecord(const uint8_t* frame, uint32_t index, Args&... args)
+	{
+		Record::decode(getRecord(frame, index), args...);
+	}
+};
+
+
+/*
+ * Messages sent by the client
+ */
+
+// x, y, z
+typedef MessageSchema<PLAYER_MOVE, FieldList<float, float, float> > PlayerMoveMessage;
+
+// No content
+typedef MessageSchema<PLAYER_SELF_ANNIHILATE, FieldList<> > PlayerSelfAnnihilateMessage;
+
+// x, y, z
+typedef MessageSchema<PLAYER_SPAWN, FieldList<float, float, float> > PlayerSpawnMessage;
+
+
+/*
+ * Messages sent by the server
+ */
+
+// Player ID assigned to the client
+typedef MessageSchema<PLAYER_JOIN_RESPONSE, FieldList<int32_t> > PlayerJoinResponseMessage;
+
+// Number of players, followed by one record for each player: ID, x, y, z
+typedef MessageSchema<SERVER_MAP_UPDATE, FieldList<uint16_t>, FieldList<int32_t, float, float, float> > ServerMapUpdateMessage;
+
+// Player ID, x, y, z
+typedef MessageSchema<PLAYER_SPAWN_WITH_ID, FieldList<int32_t, float, float, float> > PlayerSpawnWithIDMessage;
+
+// ID of the self-annihilated player, number of players killed, followed by the ID of each player killed
+typedef MessageSchema<ANNIHILATION_RESULTS, FieldList<int32_t, uint16_t>, FieldList<int32_t> > AnnihilationResultsMessage;
+
+
+static_assert(PlayerMoveMessage::FIXED_SIZE == 18, "Player move message must be 18 bytes");
+static_assert(PlayerSelfAnnihilateMessage::FIXED_SIZE == 6, "Player self-annihilate message must be 6 bytes");
+static_assert(PlayerSpawnMessage::FIXED_SIZE == 18, "Player spawn message must be 18 bytes");
+static_assert(PlayerJoinResponseMessage::FIXED_SIZE == 10, "Player join response message must be 10 bytes");
+static_assert(ServerMapUpdateMessage::FIXED_SIZE == 8 && ServerMapUpdateMessage::RECORD_SIZE == 16, "Wrong map update message layout");
+static_assert(PlayerSpawnWithIDMessage::FIXED_SIZE == 22, "Player spawn with ID message must be 22 bytes");
+static_assert(AnnihilationResultsMessage::FIXED_SIZE == 12 && AnnihilationResultsMessage::RECORD_SIZE == 4, "Wrong annihilation results message layout");
+
+#endif
@@ -0,0 +1,144 @@
+#include "ProximityKernel.h"
+
+
+typedef uint64_t (*WordFunction)(const PlayerPositions& positions, uint32_t base, float x, float y, float z, float radiusSquared);
+
+
+#if SIMD_X86
+
+// Estimate 4 coordinates of an axis from their observed values and velocities, and keep them inside the arena
+__attribute__((target("sse2")))
+static inline __m128 extrapolateSSE(const float* vs, const float* velocities, __m128 elapsed)
+{
+	__m128 v = _mm_add_ps(_mm_loadu_ps(vs), _mm_mul_ps(_mm_loadu_ps(velocities), elapsed));
+	
+	return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1));
+}
+
+
+// Get the mask of the 64 players starting at the slot base whose estimated positions are within the sphere
+__attribute__((target("sse2")))
+static uint64_t testWordSSE(const PlayerPositions& positions, uint32_t base, float x, float y, float z, float radiusSquared)
+{
+	__m128 px = _mm_set1_ps(x);
+	__m128 py = _mm_set1_ps(y);
+	__m128 pz = _mm_set1_ps(z);
+	__m128 r2 = _mm_set1_ps(radiusSquared);
+	__m128 elapsed = _mm_set1_ps(positions.elapsed);
+	
+	uint64_t mask = 0;
+	
+	for (uint32_t i = base; i < base + 64; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(extrapolateSSE(positions.xs + i, positions.vxs + i, elapsed), px);
+		__m128 dy = _mm_sub_ps(extrapolateSSE(positions.ys + i, positions.vys + i, elapsed), py);
+		__m128 dz = _mm_sub_ps(extrapolateSSE(positions.zs + i, positions.vzs + i, elapsed), pz);
+		
+		__m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		
+		// One bit per lane, in slot order
+		mask |= (uint64_t)_mm_movemask_ps(_mm_cmple_ps(d2, r2)) << (i - base);
+	}
+	
+	return mask;
+}
+
+
+__attribute__((target("avx")))
+static inline __m256 extrapolateAVX(const float* vs, const float* velocities, __m256 elapsed)
+{
+	__m256 v = _mm256_add_ps(_mm256_loadu_ps(vs), _mm256_mul_ps(_mm256_loadu_ps(velocities), elapsed));
+	
+	return _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1));
+}
+
+
+__attribute__((target("avx")))
+static uint64_t testWordAVX(const PlayerPositions& positions, uint32_t base, float x, float y, float z, float radiusSquared)
+{
+	__m256 px = _mm256_set1_ps(x);
+	__m256 py = _mm256_set1_ps(y);
+	__m256 pz = _mm256_set1_ps(z);
+	__m256 r2 = _mm256_set1_ps(radiusSquared);
+	__m256 elapsed = _mm256_set1_ps(positions.elapsed);
+	
+	uint64_t mask = 0;
+	
+	for (uint32_t i = base; i < base + 64; i += 8)
+	{
+		__m256 dx = _mm256_sub_ps(extrapolateAVX(positions.xs + i, positions.vxs + i, elapsed), px);
+		__m256 dy = _mm256_sub_ps(extrapolateAVX(positions.ys + i, positions.vys + i, elapsed), py);
+		__m256 dz = _mm256_sub_ps(extrapolateAVX(positions.zs + i, positions.vzs + i, elapsed), pz);
+		
+		__m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+		
+		mask |= (uint64_t)_mm256_movemask_ps(_mm256_cmp_ps(d2, r2, _CMP_LE_OQ)) << (i - base);
+	}
+	
+	return mask;
+}
+
+#endif
+
+
+// Get the mask of the 64 players starting at the slot base whose estimated positions are within the sphere
+// Used when the CPU has no SSE2, and on other architectures
+static uint64_t testWordScalar(const PlayerPositions& positions, uint32_t base, float x, float y, float z, float radiusSquared)
+{
+	uint64_t mask = 0;
+	
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		mask |= (uint64_t)(positions.getDistanceSquared(base + i, x, y, z) <= radiusSquared) << i;
+	}
+	
+	return mask;
+}
+
+
+// Choose the fastest implementation supported by the CPU
+static WordFunction selectWordFunction()
+{
+#if SIMD_X86
+	if (cpuHasAVX()) return testWordAVX;
+	if (cpuHasSSE2()) return testWordSSE;
+#endif
+	return testWordScalar;
+}
+
+
+static const WordFunction testWord = selectWordFunction();
+
+
+uint32_t ProximityKernel::findInRadius(const PlayerPositions& positions, const uint64_t* aliveBits, uint32_t numWords,
+									   float x, float y, float z, float radiusSquared, uint64_t* hits)
+{
+	uint32_t numHits = 0;
+	
+	for (uint32_t index = 0; index < numWords; index++)
+	{
+		uint64_t alive = aliveBits[index];
+		
+		// Skip the words without any live player
+		if (alive == 0)
+		{
+			hits[index] = 0;
+			continue;
+		}
+		
+		hits[index] = testWord(positions, index << 6, x, y, z, radiusSquared) & alive;
+		numHits += __builtin_popcountll(hits[index]);
+	}
+	
+	return numHits;
+}
+
+
+const char* ProximityKernel::getImplementationName()
+{
+#if SIMD_X86
+	if (testWord == testWordAVX) return "AVX";
+	if (testWord == testWordSSE) return "SSE";
+#endif
+	return "scalar";
+}
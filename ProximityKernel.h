@@ -0,0 +1,39 @@
+#ifndef PROXIMITY_KERNEL_H
+#define PROXIMITY_KERNEL_H
+
+#include <stdint.h>
+#include "Simd.h"
+#include "PlayerPositions.h"
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ * 
+ * Batch proximity test of the players of a structure-of-arrays table against a point.
+ * 
+ * The position of every live player is estimated at the time of the query (see PlayerPositions.h),
+ * and its squared distance to the point is compared against the squared radius, so no square root is needed.
+ * The players are tested 4 (SSE) or 8 (AVX) at a time, 64 players per word of the alive bitmap,
+ * and words without any live player are skipped.
+ * The result is a hit mask with one bit per slot, laid out like the alive bitmap, and the number of hits.
+ * The implementation is chosen once at runtime based on the CPU, with a scalar fallback.
+ * 
+ *********************************************************************************************************************************************/
+
+class ProximityKernel
+{
+	public:
+	
+		// Test the players of numWords * 64 slots against the sphere of center {x, y, z}
+		// The arrays of positions must have numWords * 64 entries, and the slots past the last player must not be alive
+		// The bit of each live player within the sphere is set in hits, which must have numWords words
+		// Return the number of players within the sphere
+		static uint32_t findInRadius(const PlayerPositions& positions, const uint64_t* aliveBits, uint32_t numWords,
+									 float x, float y, float z, float radiusSquared, uint64_t* hits);
+		
+		// Get the name of the implementation chosen for this CPU
+		static const char* getImplementationName();
+};
+
+#endif
@@ -1,62 +1,65 @@
 #include "PunisherBot.h"
 
 
-PunisherBot::PunisherBot(int numPlayers, int ID) : Bot(numPlayers, ID)
+PunisherBot::PunisherBot(int ID) : Bot(ID)
 {
-	fprintf(stdout, "Punisher bot created\n");
+	LOG(LOG_LEVEL_INFO, "Punisher bot created\n");
 }
 
 
 int PunisherBot::performAction()
 {
 	// Do nothing if the player has not been created
-	if (!players[botID].isCreated) return STANDBY;
+	if (!self.isCreated) return STANDBY;
 	
 	// If cooldown is not finished
 	if (!coolDownDone()) return STANDBY;
 	
 	// If the player is not alive
-	if (!players[botID].isAlive)
+	if (!self.isAlive)
 	{
 		// Generate a random spawn location
-		srand(time(NULL));
 		
-		players[botID].x = (rand() % 10)/(float)10;
-		players[botID].y = (rand() % 10)/(float)10;
-		players[botID].z = (rand() % 10)/(float)10;
+		self.x = random.nextBelow(10)/(float)10;
+		self.y = random.nextBelow(10)/(float)10;
+		self.z = random.nextBelow(10)/(float)10;
 		
-		players[botID].isAlive = true;
+		self.isAlive = true;
 		
 		// reset the last action time;
-		lastActionTime = clock();
+		lastActionTime = getTime();
 		
 		return SPAWN;
 	}
 	
-	// Check if there's any alive player within explosion range
-	for (int i = 0; i < numPlayers; i++)
+	// Decide on the estimated current positions of the other players
+	predictPositions();
+	
+	// Look for the killer of the bot
+	Target killer;
+	
+	// if the target is found to be killed, reset the target
+	if (killerID != -1 && !findPlayer(killerID, killer))
 	{
-		// if the target is found to be killed, reset the target
-		if (i == killerID && !players[i].isAlive)
-		{
-			killerID = -1;
-		}
+		killerID = -1;
+	}
+	
+	// If a live player is within explosion range
+	Target target;
+	
+	if (findTarget(target))
+	{
+		LOG(LOG_LEVEL_DEBUG, "Targeting player %d at {%.2f, %.2f, %.2f}\n", target.id, target.x, target.y, target.z);
+		LOG(LOG_LEVEL_DEBUG, "Distance to target: %.2f\n", getDistance(target));
 		
-		// If a live player that is not this bot is within explosion range
-		if (players[i].isAlive && i != botID && getDistance(botID, i) <= EXPLOSION_RADIUS)
-		{
-			fprintf(stdout, "Targeting player %d at {%.2f, %.2f, %.2f}\n", i, players[i].x, players[i].y, players[i].z);
-			fprintf(stdout, "Distance to target: %.2f\n", getDistance(botID, i));
-			
-			// Self-annihilate
-			players[botID].isAlive = false;
-			lastActionTime = clock();
-			
-			// If the player killed is also the target, reset target
-			killerID = -1;
-			
-			return EXPLODE;
-		}
+		// Self-annihilate
+		self.isAlive = false;
+		lastActionTime = getTime();
+		
+		// If the player killed is also the target, reset target
+		killerID = -1;
+		
+		return EXPLODE;
 	}
 	
 	// If no player is in range, move in 1 out of 6 directions
@@ -73,8 +76,7 @@ int PunisherBot::performAction()
 	if (killerID == -1)
 	{
 		// Generate a random direction
-		srand(time(NULL));
-		dir = rand() % 6;
+		dir = random.nextBelow(6);
 	}
 	else
 	{
@@ -88,26 +90,30 @@ int PunisherBot::performAction()
 		// 4: z positive
 		// 5: z negative
 		
-		float xDiff = abs(players[botID].x - players[killerID].x);
-		float yDiff = abs(players[botID].y - players[killerID].y);
-		float zDiff = abs(players[botID].z - players[killerID].z);
+		float targetX = killer.x;
+		float targetY = killer.y;
+		float targetZ = killer.z;
+		
+		float xDiff = abs(self.x - targetX);
+		float yDiff = abs(self.y - targetY);
+		float zDiff = abs(self.z - targetZ);
 		
 		float largest = (xDiff > yDiff) ? xDiff : yDiff;
 		largest = (largest > zDiff) ? largest : zDiff;
 		
 		if (largest == xDiff)
 		{
-			if (players[botID].x < players[killerID].x) dir = 0;
+			if (self.x < targetX) dir = 0;
 			else dir = 1;
 		}
 		else if (largest == yDiff)
 		{
-			if (players[botID].y < players[killerID].y) dir = 2;
+			if (self.y < targetY) dir = 2;
 			else dir = 3;
 		}
 		else if (largest == zDiff)
 		{
-			if (players[botID].z < players[killerID].z) dir = 4;
+			if (self.z < targetZ) dir = 4;
 			else dir = 5;
 		}
 	}
@@ -117,85 +123,85 @@ int PunisherBot::performAction()
 		case 0:
 		{
 			// if moving in the +x direction causes the bot to be out of range
-			if (players[botID].x + BOT_STEP > 1)
+			if (self.x + BOT_STEP > 1)
 			{
-				players[botID].x = 1;
+				self.x = 1;
 			}
 			else
 			{
-				players[botID].x += BOT_STEP;
+				self.x += BOT_STEP;
 			}
 			break;
 		}
 		case 1:
 		{
 			// if moving in the -x direction causes the bot to be out of range
-			if (players[botID].x - BOT_STEP < 0)
+			if (self.x - BOT_STEP < 0)
 			{
-				players[botID].x = 0;
+				self.x = 0;
 			}
 			else
 			{
-				players[botID].x -= BOT_STEP;
+				self.x -= BOT_STEP;
 			}
 			break;
 		}
 		case 2:
 		{
 			// if moving in the +y direction causes the bot to be out of range
-			if (players[botID].y + BOT_STEP > 1)
+			if (self.y + BOT_STEP > 1)
 			{
-				players[botID].y = 1;
+				self.y = 1;
 			}
 			else
 			{
-				players[botID].y += BOT_STEP;
+				self.y += BOT_STEP;
 			}
 			break;
 		}
 		case 3:
 		{
 			// if moving in the -y direction causes the bot to be out of range
-			if (players[botID].y - BOT_STEP < 0)
+			if (self.y - BOT_STEP < 0)
 			{
-				players[botID].y = 0;
+				self.y = 0;
 			}
 			else
 			{
-				players[botID].y -= BOT_STEP;
+				self.y -= BOT_STEP;
 			}
 			break;
 		}
 		case 4:
 		{
 			// if moving in the +z direction causes the bot to be out of range
-			if (players[botID].z + BOT_STEP > 1)
+			if (self.z + BOT_STEP > 1)
 			{
-				players[botID].z = 1;
+				self.z = 1;
 			}
 			else
 			{
-				players[botID].z += BOT_STEP;
+				self.z += BOT_STEP;
 			}
 			break;
 		}
 		case 5:
 		{
 			// if moving in the -z direction causes the bot to be out of range
-			if (players[botID].z - BOT_STEP < 0)
+			if (self.z - BOT_STEP < 0)
 			{
-				players[botID].z = 0;
+				self.z = 0;
 			}
 			else
 			{
-				players[botID].z -= BOT_STEP;
+				self.z -= BOT_STEP;
 			}
 			break;
 		}
 	}
 	
 	// reset the cooldown time
-	lastActionTime = clock();
+	lastActionTime = getTime();
 	
 	return MOVE;
 }
@@ -3,16 +3,15 @@
 
 #include "Bot.h"
 
-class PunisherBot: public Bot
+class PunisherBot final: public Bot
 {
 	private:
 	
 	public:
 
 		// Create a punisher bot
-		// Inform the bot of the maximum number of players in the arena (including itself)
 		// Assign an ID to the bot
-		PunisherBot(int numPlayers, int ID);
+		PunisherBot(int ID);
 		
 		int performAction() override;
 };
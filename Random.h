@@ -0,0 +1,83 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+
+/********************************************************************************************************************************************
+ * 
+ * Small and fast pseudo-random number generator (xoshiro128**), owned by each bot.
+ * 
+ * Each bot has its own generator, seeded from the master seed of the process and the bot's ID,
+ * so that bots running on different threads never share any state, different bots make different choices,
+ * and a run can be reproduced by reusing the same master seed.
+ * This is not a cryptographic generator.
+ * 
+ *********************************************************************************************************************************************/
+
+class Random
+{
+	private:
+	
+		uint32_t state[4];
+		
+		static inline uint32_t rotateLeft(uint32_t x, int k)
+		{
+			return (x << k) | (x >> (32 - k));
+		}
+		
+		// Step of the SplitMix64 generator, used to spread the seed over the whole state
+		static inline uint64_t splitMix(uint64_t& x)
+		{
+			uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+		
+	public:
+	
+		Random()
+		{
+			seed(0, 0);
+		}
+		
+		// Seed the generator from a master seed and a stream number, such as the ID of a bot
+		inline void seed(uint64_t masterSeed, uint64_t stream)
+		{
+			uint64_t x = masterSeed ^ splitMix(stream);
+			
+			uint64_t a = splitMix(x);
+			uint64_t b = splitMix(x);
+			
+			state[0] = (uint32_t)a;
+			state[1] = (uint32_t)(a >> 32);
+			state[2] = (uint32_t)b;
+			state[3] = (uint32_t)(b >> 32);
+		}
+		
+		// Get the next 32 random bits
+		inline uint32_t next()
+		{
+			uint32_t result = rotateLeft(state[1] * 5, 7) * 9;
+			uint32_t t = state[1] << 9;
+			
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = rotateLeft(state[3], 11);
+			
+			return result;
+		}
+		
+		// Get a random integer in [0, n)
+		// Uses a multiplication instead of a modulo, which is faster and less biased
+		inline uint32_t nextBelow(uint32_t n)
+		{
+			return (uint32_t)(((uint64_t)next() * n) >> 32);
+		}
+};
+
+#endif
@@ -0,0 +1,190 @@
+#include "SharedWorld.h"
+
+
+SharedWorld::SharedWorld()
+{
+	latest = 0;
+	
+	for (uint32_t i = 0; i < SHARED_WORLD_HISTORY; i++)
+	{
+		keys[i] = 0;
+	}
+}
+
+
+uint64_t SharedWorld::hashRecords(const uint8_t* records, uint32_t numBytes)
+{
+	uint64_t hash = numBytes;
+	uint32_t i = 0;
+	
+	// 8 bytes at a time, mixed with a multiplication, so hashing costs far less than decoding
+	for (; i + 8 <= numBytes; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, records + i, 8);
+		
+		hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+		hash ^= hash >> 29;
+	}
+	
+	for (; i < numBytes; i++)
+	{
+		hash = (hash ^ records[i]) * 0x100000001B3ULL;
+	}
+	
+	return hash;
+}
+
+
+shared_ptr<const WorldSnapshot> SharedWorld::findSnapshot(const uint8_t* records, uint32_t numBytes, uint64_t key, int64_t time) const
+{
+	// The latest snapshot first, since most clients are up to date
+	uint32_t start = latest;
+	
+	for (uint32_t i = 0; i < SHARED_WORLD_HISTORY; i++)
+	{
+		uint32_t index = (start + SHARED_WORLD_HISTORY - i) % SHARED_WORLD_HISTORY;
+		
+		// Loading a snapshot takes a reference on it, so only the one with the same hash is loaded
+		if (keys[index].load(memory_order_acquire) != key) continue;
+		
+		shared_ptr<const WorldSnapshot> snapshot = atomic_load(&history[index]);
+		
+		// The snapshot may have been replaced since its hash was read, so it is compared in full
+		if (snapshot && snapshot->key == key && snapshot->records.size() == numBytes && memcmp(snapshot->records.data(), records, numBytes) == 0
+				&& time - snapshot->players.getObservedTime() <= STOPPED_VELOCITY_NANOS)
+		{
+			return snapshot;
+		}
+	}
+	
+	return shared_ptr<const WorldSnapshot>();
+}
+
+
+shared_ptr<WorldSnapshot> SharedWorld::buildSnapshot(const uint8_t* records, uint16_t numPlayers, int64_t time, const WorldSnapshot* previous)
+{
+	// Snapshots that are not published are decoded outside the publish lock, so each thread has its own decoder
+	static thread_local MapUpdateDecoder decoder;
+	
+	decoder.decode(records, numPlayers);
+	
+	const int32_t* ids = decoder.getIDs();
+	const float* xs = decoder.getX();
+	const float* ys = decoder.getY();
+	const float* zs = decoder.getZ();
+	
+	shared_ptr<WorldSnapshot> snapshot = make_shared<WorldSnapshot>(numPlayers);
+	PlayerTable& players = snapshot->players;
+	
+	snapshot->records.assign(records, records + numPlayers * ServerMapUpdateMessage::RECORD_SIZE);
+	players.setObservedTime(time);
+	
+	for (uint32_t i = 0; i < numPlayers; i++)
+	{
+		int32_t slot = players.insert(ids[i]);
+		
+		players.setPosition(slot, xs[i], ys[i], zs[i]);
+		players.setAlive(slot, true);
+		
+		int32_t previousSlot = (previous == NULL) ? -1 : previous->players.find(ids[i]);
+		
+		// A player that was not in the previous update has appeared somewhere, so it has no velocity yet
+		if (previousSlot == -1 || !previous->players.isAlive(previousSlot))
+		{
+			players.setMotion(slot, 0, 0, 0, time);
+			continue;
+		}
+		
+		float vx = previous->players.getVX(previousSlot);
+		float vy = previous->players.getVY(previousSlot);
+		float vz = previous->players.getVZ(previousSlot);
+		int64_t changeTime = previous->players.getChangeTime(previousSlot);
+		
+		float dx = xs[i] - previous->players.getX(previousSlot);
+		float dy = ys[i] - previous->players.getY(previousSlot);
+		float dz = zs[i] - previous->players.getZ(previousSlot);
+		
+		// The velocity is the displacement between the last two changes of position, divided by the time between them,
+		// which also gives a sensible average speed for players that move in steps
+		if (dx != 0 || dy != 0 || dz != 0)
+		{
+			int64_t interval = time - changeTime;
+			
+			if (interval >= MIN_VELOCITY_INTERVAL_NANOS)
+			{
+				float seconds = nanosToSeconds(interval);
+				
+				vx = dx / seconds;
+				vy = dy / seconds;
+				vz = dz / seconds;
+			}
+			
+			changeTime = time;
+		}
+		else if (time - changeTime > STOPPED_VELOCITY_NANOS)
+		{
+			// Otherwise a player that stopped would keep the velocity of its last move forever
+			vx = 0;
+			vy = 0;
+			vz = 0;
+		}
+		
+		players.setMotion(slot, vx, vy, vz, changeTime);
+	}
+	
+	return snapshot;
+}
+
+
+shared_ptr<const WorldSnapshot> SharedWorld::publish(const uint8_t* records, uint16_t numPlayers, int64_t time, const shared_ptr<const WorldSnapshot>& current,
+		bool& isShared)
+{
+	uint32_t numBytes = numPlayers * ServerMapUpdateMessage::RECORD_SIZE;
+	uint64_t key = hashRecords(records, numBytes);
+	
+	shared_ptr<const WorldSnapshot> snapshot = findSnapshot(records, numBytes, key, time);
+	
+	isShared = (bool)snapshot;
+	
+	if (snapshot) return snapshot;
+	
+	unique_lock<mutex> guard(publishLock);
+	
+	// Another client may have published the same update while this one waited for the lock
+	snapshot = findSnapshot(records, numBytes, key, time);
+	
+	isShared = (bool)snapshot;
+	
+	if (snapshot) return snapshot;
+	
+	shared_ptr<const WorldSnapshot> previous = atomic_load(&history[latest]);
+	
+	// The client lags behind the latest snapshot, so its update may well be older than it
+	// It is decoded against the client's own previous update, for this client only
+	if (previous && (!current || current->sequence != previous->sequence))
+	{
+		guard.unlock();
+		
+		shared_ptr<WorldSnapshot> lagging = buildSnapshot(records, numPlayers, time, current.get());
+		
+		lagging->key = key;
+		lagging->sequence = current ? current->sequence : 0;
+		
+		return lagging;
+	}
+	
+	shared_ptr<WorldSnapshot> newest = buildSnapshot(records, numPlayers, time, previous.get());
+	
+	newest->key = key;
+	newest->sequence = previous ? previous->sequence + 1 : 1;
+	
+	// Replace the oldest snapshot, which is freed once no bot holds it
+	uint32_t next = (latest + 1) % SHARED_WORLD_HISTORY;
+	
+	atomic_store(&history[next], (shared_ptr<const WorldSnapshot>)newest);
+	keys[next].store(key, memory_order_release);
+	latest = next;
+	
+	return newest;
+}
@@ -0,0 +1,96 @@
+#ifndef SHARED_WORLD_H
+#define SHARED_WORLD_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "PlayerTable.h"
+#include "MapUpdateDecoder.h"
+#include "Protocol.h"
+#include "Timing.h"
+
+
+// Number of recent snapshots kept to recognize the map updates received by several clients
+// The clients of a swarm receive each map update at slightly different times, so an update may arrive after a newer one
+#define SHARED_WORLD_HISTORY	4
+
+using namespace std;
+
+
+// State of the arena in a map update, shared by the bots of a process
+// A snapshot is never modified once published
+struct WorldSnapshot
+{
+	PlayerTable players; // positions and velocities of the players in the map update
+	vector<uint8_t> records; // records of the map update as received, to recognize it when it is received again
+	uint64_t key; // hash of the records, compared before the records themselves
+	uint64_t sequence; // order of publication, or the sequence of the snapshot it follows for a snapshot that is not published
+	
+	WorldSnapshot(uint32_t numPlayers) : players(numPlayers), key(0), sequence(0) {}
+};
+
+
+/********************************************************************************************************************************************
+ *
+ * World model shared by all the bots of a process.
+ *
+ * Every client of a swarm receives the same map updates, and each bot used to decode them into its own player table,
+ * so the memory and the decoding work grew with the number of bots times the number of players.
+ * Instead, each map update is decoded once into an immutable snapshot, and the bots hold a reference to the latest snapshot they received.
+ * A bot only keeps its private state (its ID, its killer and its cooldown), along with the few events received since its snapshot.
+ *
+ * The recent snapshots are published in a small history of atomic shared pointers (read-copy-update):
+ * readers never block on a writer and never see a snapshot being built,
+ * and a snapshot is freed once the last bot holding it moves on to a newer one.
+ * A client hashes the records it receives once, looks the hash up in the history, and only decodes the records if no snapshot matches.
+ * The records are only compared in full with the snapshot whose hash matches, to rule out a collision.
+ * Decoding is serialized by a lock, so that an update received by several clients at once is decoded only once.
+ * The velocity of each player is derived from its position in the previous snapshot (see PlayerTable.h),
+ * and cleared once its position hasn't changed for STOPPED_VELOCITY_NANOS.
+ *
+ * The map updates have no sequence number, so their order is inferred from the clients: a client receives them in order,
+ * so an update that matches no snapshot is only newer than the latest one if the client's previous update was the latest one.
+ * The update of a client that lags further behind is decoded for that client alone, against its own previous snapshot,
+ * and is never published, so that it can't reverse the velocities of the other bots.
+ *
+ *********************************************************************************************************************************************/
+
+class SharedWorld
+{
+	private:
+		
+		shared_ptr<const WorldSnapshot> history[SHARED_WORLD_HISTORY]; // most recent snapshots, only accessed atomically
+		atomic<uint64_t> keys[SHARED_WORLD_HISTORY]; // hashes of the records of the snapshots, so that a lookup only loads the matching one
+		atomic<uint32_t> latest; // index of the latest snapshot in the history, only written under publishLock
+		mutex publishLock; // serializes the decoding and publication of new snapshots
+		
+		// Get the snapshot of the history holding the given records, whose hash is key, or NULL if there is none
+		// Snapshots observed more than STOPPED_VELOCITY_NANOS before the given time are not reused, so that the velocities
+		// of the players that stopped are cleared even when the map doesn't change
+		shared_ptr<const WorldSnapshot> findSnapshot(const uint8_t* records, uint32_t numBytes, uint64_t key, int64_t time) const;
+		
+		// Hash the records of a map update
+		static uint64_t hashRecords(const uint8_t* records, uint32_t numBytes);
+		
+		// Decode numPlayers records observed at the given time into a new snapshot
+		// The velocities are derived from the previous snapshot, if any
+		// Thread-safe, since each thread decodes with its own decoder
+		static shared_ptr<WorldSnapshot> buildSnapshot(const uint8_t* records, uint16_t numPlayers, int64_t time, const WorldSnapshot* previous);
+	
+	public:
+		
+		SharedWorld();
+		
+		// Get the snapshot of the map update with numPlayers records starting at records, received at the given time
+		// current is the snapshot of the previous map update received by the same client (NULL if none)
+		// The records are only decoded if they don't match a recent snapshot
+		// The records must be fully inside the frame (see ServerMapUpdateMessage::hasRecords)
+		// isShared is set if the snapshot was decoded for another client
+		shared_ptr<const WorldSnapshot> publish(const uint8_t* records, uint16_t numPlayers, int64_t time, const shared_ptr<const WorldSnapshot>& current,
+				bool& isShared);
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// SIMD code paths are compiled for x86 only, and each of them is compiled for its own instruction set with a target attribute
+// The right path is chosen at runtime based on the instruction sets supported by the CPU
+// The scalar path is always compiled, as the last fallback, and is the only one on other architectures
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+
+// Determine if the CPU supports SSE2 instructions
+// Always true on x86-64, but not on every 32-bit x86 CPU
+inline bool cpuHasSSE2()
+{
+#if SIMD_X86
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#else
+	return false;
+#endif
+}
+
+
+// Determine if the CPU supports AVX instructions
+inline bool cpuHasAVX()
+{
+#if SIMD_X86
+	// Needed when called before main, from a static initializer
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx");
+#else
+	return false;
+#endif
+}
+
+
+// Determine if the CPU supports AVX2 instructions
+inline bool cpuHasAVX2()
+{
+#if SIMD_X86
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,258 @@
+#include "SpatialGrid.h"
+
+
+// Size of a cell along each axis
+static const float CELL_SIZE = 1.0f / SPATIAL_GRID_CELLS;
+
+
+// Call visit(cell) for each cell at Chebyshev distance k from the cell {cx, cy, cz}, stopping as soon as it returns true
+// Return true if visit stopped the iteration
+template <typename Visitor>
+static bool visitShell(int32_t cx, int32_t cy, int32_t cz, int32_t k, Visitor visit)
+{
+	for (int32_t x = cx - k; x <= cx + k; x++)
+	{
+		if (x < 0 || x >= SPATIAL_GRID_CELLS) continue;
+		
+		for (int32_t y = cy - k; y <= cy + k; y++)
+		{
+			if (y < 0 || y >= SPATIAL_GRID_CELLS) continue;
+			
+			bool onShell = (x == cx - k || x == cx + k || y == cy - k || y == cy + k);
+			
+			for (int32_t z = cz - k; z <= cz + k; z++)
+			{
+				if (z < 0 || z >= SPATIAL_GRID_CELLS) continue;
+				
+				// Inside the shell, only the two faces along z are on it
+				if (!onShell && z != cz - k && z != cz + k) continue;
+				
+				if (visit((x * SPATIAL_GRID_CELLS + y) * SPATIAL_GRID_CELLS + z)) return true;
+			}
+		}
+	}
+	
+	return false;
+}
+
+
+// Determine if a slot is in the list of slots excluded from a query
+static bool isExcluded(const vector<int32_t>& excluded, int32_t slot)
+{
+	for (size_t i = 0; i < excluded.size(); i++)
+	{
+		if (excluded[i] == slot) return true;
+	}
+	
+	return false;
+}
+
+
+SpatialGrid::SpatialGrid() : cells(SPATIAL_GRID_CELLS * SPATIAL_GRID_CELLS * SPATIAL_GRID_CELLS)
+{
+}
+
+
+int32_t SpatialGrid::getCellCoord(float v)
+{
+	int32_t coord = (int32_t)(v * SPATIAL_GRID_CELLS);
+	
+	// Keep the players outside the arena (or on its far border) in the border cells
+	if (!(v >= 0) || coord < 0) return 0;
+	if (coord >= SPATIAL_GRID_CELLS) return SPATIAL_GRID_CELLS - 1;
+	
+	return coord;
+}
+
+
+int32_t SpatialGrid::getCell(float x, float y, float z)
+{
+	return (getCellCoord(x) * SPATIAL_GRID_CELLS + getCellCoord(y)) * SPATIAL_GRID_CELLS + getCellCoord(z);
+}
+
+
+void SpatialGrid::addToCell(int32_t slot, int32_t cell)
+{
+	cellOfSlot[slot] = cell;
+	indexInCell[slot] = cells[cell].size();
+	cells[cell].push_back(slot);
+}
+
+
+void SpatialGrid::removeFromCell(int32_t slot)
+{
+	vector<int32_t>& cell = cells[cellOfSlot[slot]];
+	
+	// Move the last slot of the cell in place of the removed one
+	int32_t last = cell.back();
+	
+	cell[indexInCell[slot]] = last;
+	indexInCell[last] = indexInCell[slot];
+	cell.pop_back();
+	
+	cellOfSlot[slot] = -1;
+}
+
+
+void SpatialGrid::insert(int32_t slot, float x, float y, float z)
+{
+	if ((size_t)slot >= cellOfSlot.size())
+	{
+		cellOfSlot.resize(slot + 1, -1);
+		indexInCell.resize(slot + 1, 0);
+	}
+	
+	if (cellOfSlot[slot] != -1) removeFromCell(slot);
+	
+	addToCell(slot, getCell(x, y, z));
+}
+
+
+void SpatialGrid::move(int32_t slot, float x, float y, float z)
+{
+	int32_t cell = getCell(x, y, z);
+	
+	// Most moves stay within the same cell
+	if (cellOfSlot[slot] == cell) return;
+	
+	removeFromCell(slot);
+	addToCell(slot, cell);
+}
+
+
+void SpatialGrid::remove(int32_t slot)
+{
+	if (contains(slot)) removeFromCell(slot);
+}
+
+
+bool SpatialGrid::contains(int32_t slot) const
+{
+	return (size_t)slot < cellOfSlot.size() && cellOfSlot[slot] != -1;
+}
+
+
+uint32_t SpatialGrid::countCellsInRadius(float x, float y, float z, float radius)
+{
+	uint32_t numX = getCellCoord(x + radius) - getCellCoord(x - radius) + 1;
+	uint32_t numY = getCellCoord(y + radius) - getCellCoord(y - radius) + 1;
+	uint32_t numZ = getCellCoord(z + radius) - getCellCoord(z - radius) + 1;
+	
+	return numX * numY * numZ;
+}
+
+
+uint32_t SpatialGrid::findInRadius(const PlayerPositions& positions, float x, float y, float z, float radius, uint64_t* hits) const
+{
+	float radiusSquared = radius * radius;
+	uint32_t numHits = 0;
+	
+	// Visit the cells overlapping the bounding box of the sphere, widened by how far the players may have moved from their cells
+	float reach = radius + positions.maxDisplacement;
+	
+	int32_t minX = getCellCoord(x - reach), maxX = getCellCoord(x + reach);
+	int32_t minY = getCellCoord(y - reach), maxY = getCellCoord(y + reach);
+	int32_t minZ = getCellCoord(z - reach), maxZ = getCellCoord(z + reach);
+	
+	for (int32_t cx = minX; cx <= maxX; cx++)
+	{
+		for (int32_t cy = minY; cy <= maxY; cy++)
+		{
+			for (int32_t cz = minZ; cz <= maxZ; cz++)
+			{
+				const vector<int32_t>& cell = cells[(cx * SPATIAL_GRID_CELLS + cy) * SPATIAL_GRID_CELLS + cz];
+				
+				for (size_t i = 0; i < cell.size(); i++)
+				{
+					int32_t slot = cell[i];
+					
+					if (positions.getDistanceSquared(slot, x, y, z) <= radiusSquared)
+					{
+						hits[slot >> 6] |= (uint64_t)1 << (slot & 63);
+						numHits++;
+					}
+				}
+			}
+		}
+	}
+	
+	return numHits;
+}
+
+
+int32_t SpatialGrid::findAnyInRadius(const PlayerPositions& positions, const vector<int32_t>& excluded, float x, float y, float z, float radius) const
+{
+	float radiusSquared = radius * radius;
+	float reach = radius + positions.maxDisplacement;
+	int32_t found = -1;
+	
+	int32_t cx = getCellCoord(x), cy = getCellCoord(y), cz = getCellCoord(z);
+	
+	// The cells of shell k are at least (k - 1) cells away from the center, so the shells beyond the reach can be skipped
+	for (int32_t k = 0; k < SPATIAL_GRID_CELLS && (k - 1) * CELL_SIZE <= reach; k++)
+	{
+		bool stop = visitShell(cx, cy, cz, k, [&](int32_t index) -> bool
+		{
+			const vector<int32_t>& cell = cells[index];
+			
+			for (size_t i = 0; i < cell.size(); i++)
+			{
+				int32_t slot = cell[i];
+				
+				if (positions.getDistanceSquared(slot, x, y, z) <= radiusSquared && !isExcluded(excluded, slot))
+				{
+					found = slot;
+					return true;
+				}
+			}
+			
+			return false;
+		});
+		
+		if (stop) break;
+	}
+	
+	return found;
+}
+
+
+int32_t SpatialGrid::findNearest(const PlayerPositions& positions, const vector<int32_t>& excluded, float x, float y, float z) const
+{
+	float bestSquared = 0;
+	int32_t best = -1;
+	
+	int32_t cx = getCellCoord(x), cy = getCellCoord(y), cz = getCellCoord(z);
+	
+	for (int32_t k = 0; k < SPATIAL_GRID_CELLS; k++)
+	{
+		// The players in the shells from shell k on were observed at least k - 1 cells away from the center
+		// Stop once the nearest player found so far is closer than that, less how far they may have moved since
+		float bound = (k - 1) * CELL_SIZE - positions.maxDisplacement;
+		
+		if (best != -1 && bound > 0 && bestSquared <= bound * bound) break;
+		
+		visitShell(cx, cy, cz, k, [&](int32_t index) -> bool
+		{
+			const vector<int32_t>& cell = cells[index];
+			
+			for (size_t i = 0; i < cell.size(); i++)
+			{
+				int32_t slot = cell[i];
+				
+				if (isExcluded(excluded, slot)) continue;
+				
+				float distanceSquared = positions.getDistanceSquared(slot, x, y, z);
+				
+				if (best == -1 || distanceSquared < bestSquared)
+				{
+					best = slot;
+					bestSquared = distanceSquared;
+				}
+			}
+			
+			return false;
+		});
+	}
+	
+	return best;
+}
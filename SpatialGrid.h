@@ -0,0 +1,82 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <stdint.h>
+#include <vector>
+#include "PlayerPositions.h"
+
+using namespace std;
+
+
+// Number of cells along each axis of the arena
+#define SPATIAL_GRID_CELLS		8
+
+
+/********************************************************************************************************************************************
+ * 
+ * Uniform grid over the arena, the unit cube, used as a spatial index of the live players of a PlayerTable.
+ * 
+ * Each cell holds the slots of the players located in it, and the grid is updated incrementally as players spawn, move and die.
+ * The grid only stores the slots: the coordinates are read from the arrays of the table, which are passed to each query.
+ * The cells hold the observed positions of the players, while the queries test their estimated positions (see PlayerPositions.h),
+ * so the queries widen their search by the distance the players may have moved.
+ * Players outside the arena are kept in the nearest cell on its border (the early exits of the queries assume that they are inside).
+ * 
+ * Queries only visit the cells that overlap the query sphere, closest cells first where an early exit is possible.
+ * With the explosion radius at 0.4, a sphere around a player in the middle of the arena still overlaps most of the cells,
+ * so finding every player in range is only cheaper than a full scan near the borders.
+ * Finding any single player in range, or the nearest player, usually stops after a few cells.
+ * 
+ *********************************************************************************************************************************************/
+
+class SpatialGrid
+{
+	private:
+	
+		vector<vector<int32_t> > cells; // slots of the players in each cell
+		vector<int32_t> cellOfSlot; // cell of each slot, or -1 if the slot is not in the grid
+		vector<uint32_t> indexInCell; // index of each slot in the list of its cell
+		
+		// Get the coordinate of the cell containing the coordinate v along an axis
+		static int32_t getCellCoord(float v);
+		
+		static int32_t getCell(float x, float y, float z);
+		
+		void addToCell(int32_t slot, int32_t cell);
+		
+		void removeFromCell(int32_t slot);
+		
+	public:
+	
+		SpatialGrid();
+		
+		// Add the player of a slot at {x, y, z}
+		void insert(int32_t slot, float x, float y, float z);
+		
+		// Move the player of a slot in the grid to {x, y, z}
+		void move(int32_t slot, float x, float y, float z);
+		
+		// Remove the player of a slot from the grid
+		void remove(int32_t slot);
+		
+		// Determine if the player of a slot is in the grid
+		bool contains(int32_t slot) const;
+		
+		// Get the number of cells overlapped by the sphere of center {x, y, z}
+		static uint32_t countCellsInRadius(float x, float y, float z, float radius);
+		
+		// Find the players within the sphere of center {x, y, z}
+		// The bit of each player found is set in hits, which must already be cleared and have a bit for every slot
+		// Return the number of players found
+		uint32_t findInRadius(const PlayerPositions& positions, float x, float y, float z, float radius, uint64_t* hits) const;
+		
+		// Find any player within the sphere of center {x, y, z}, other than the excluded slots, searching the cells closest to the center first
+		// Return -1 if there is none
+		int32_t findAnyInRadius(const PlayerPositions& positions, const vector<int32_t>& excluded, float x, float y, float z, float radius) const;
+		
+		// Find the player nearest to {x, y, z}, other than the excluded slots
+		// Return -1 if there is none
+		int32_t findNearest(const PlayerPositions& positions, const vector<int32_t>& excluded, float x, float y, float z) const;
+};
+
+#endif
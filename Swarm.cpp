@@ -0,0 +1,264 @@
+#include "Swarm.h"
+
+
+Swarm::Swarm(const char* serverHostName, const char* serverPortNum, int botAIType, int numBots, int numLoops, int numWorkers, int64_t decisionSlack,
+		int64_t reportInterval)
+{
+	this->reportInterval = reportInterval;
+	isReporting = false;
+	stopSignal = 0;
+	lastReportTime = monotonicNow();
+	
+	for (int i = 0; i < NUM_MESSAGE_CODES; i++)
+	{
+		lastNumMessages[i] = 0;
+		lastNumBytes[i] = 0;
+	}
+	
+	int numCores = (int)thread::hardware_concurrency();
+	
+	if (numCores < 1) numCores = 1;
+	if (numLoops < 1) numLoops = numCores;
+	
+	// There's no point in having more loops than clients
+	if (numLoops > numBots) numLoops = numBots;
+	
+	raiseFileLimit();
+	
+	decisionPool = (numWorkers > 0) ? new DecisionPool(numWorkers, numBots) : NULL;
+	
+	for (int i = 0; i < numLoops; i++)
+	{
+		loops.push_back(new EventLoop());
+		
+		if (decisionPool != NULL) loops[i]->setDecisionPool(decisionPool, numBots);
+	}
+	
+	// Shard the clients across the loops
+	for (int i = 0; i < numBots; i++)
+	{
+		PlayerClient* client = new PlayerClient(serverHostName, serverPortNum, botAIType, &world, decisionSlack);
+		
+		clients.push_back(client);
+		
+		if (loops[i % numLoops]->addClient(client) == -1)
+		{
+			LOG(LOG_LEVEL_ERROR, "Failed to start player client %d\n", i);
+		}
+	}
+	
+	LOG(LOG_LEVEL_INFO, "Swarm of %d player clients created on %d event loops\n", numBots, numLoops);
+	LOG(LOG_LEVEL_INFO, "Map update decoder: %s\n", MapUpdateDecoder::getImplementationName());
+	LOG(LOG_LEVEL_INFO, "Proximity kernel: %s\n", ProximityKernel::getImplementationName());
+	
+	if (decisionPool != NULL)
+	{
+		LOG(LOG_LEVEL_INFO, "Bot decisions taken on %d worker threads\n", decisionPool->getNumWorkers());
+	}
+	
+	if (decisionSlack >= 0)
+	{
+		LOG(LOG_LEVEL_INFO, "Bot actions scheduled on map updates, with %.1f ms of slack\n", decisionSlack / (double)NANOS_PER_MILLISECOND);
+	}
+}
+
+
+Swarm::~Swarm()
+{
+	// The workers are stopped before the clients they decide for are deleted
+	delete decisionPool;
+	
+	for (size_t i = 0; i < clients.size(); i++)
+	{
+		delete clients[i];
+	}
+	for (size_t i = 0; i < loops.size(); i++)
+	{
+		delete loops[i];
+	}
+}
+
+
+void Swarm::raiseFileLimit()
+{
+	struct rlimit limit;
+	
+	if (getrlimit(RLIMIT_NOFILE, &limit) == -1) return;
+	
+	limit.rlim_cur = limit.rlim_max;
+	
+	if (setrlimit(RLIMIT_NOFILE, &limit) == -1)
+	{
+		LOG(LOG_LEVEL_WARNING, "Failed to raise the open file limit: %s\n", strerror(errno));
+	}
+}
+
+
+void Swarm::runLoop(EventLoop* loop, int core)
+{
+	int numCores = (int)thread::hardware_concurrency();
+	
+	// Pin the loop to its core so that the loops don't compete for the same core
+	if (core >= 0 && numCores > 1)
+	{
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(core % numCores, &cpus);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	}
+	
+	loop->run();
+}
+
+
+void Swarm::run()
+{
+	LOG(LOG_LEVEL_INFO, "Player client started\n");
+	
+	vector<thread> threads;
+	
+	lastReportTime = monotonicNow();
+	isReporting = true;
+	reporter = thread(&Swarm::runReporter, this);
+	
+	// The workers are pinned to the cores after those of the loops
+	if (decisionPool != NULL) decisionPool->start((loops.size() > 1) ? (int)loops.size() : -1);
+	
+	// The first loop runs on the calling thread
+	for (size_t i = 1; i < loops.size(); i++)
+	{
+		threads.push_back(thread(runLoop, loops[i], (int)i));
+	}
+	
+	// A single loop is not pinned, so that separate client processes can spread over the cores
+	if (!loops.empty()) runLoop(loops[0], (loops.size() > 1) ? 0 : -1);
+	
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+	
+	if (decisionPool != NULL) decisionPool->stop();
+	
+	// Wake up the reporter, which sees that it is stopped
+	isReporting = false;
+	pthread_kill(reporter.native_handle(), SIGUSR1);
+	reporter.join();
+	
+	reportMetrics("exit");
+}
+
+
+int Swarm::getStopSignal()
+{
+	return stopSignal;
+}
+
+
+void Swarm::runReporter()
+{
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGUSR1);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	
+	int64_t nextReport = monotonicNow() + reportInterval;
+	
+	while (isReporting)
+	{
+		// Without periodic reports, only SIGUSR1 wakes up the reporter
+		int64_t timeout = (reportInterval > 0) ? nextReport - monotonicNow() : NANOS_PER_SECOND;
+		
+		if (timeout < 0) timeout = 0;
+		
+		struct timespec wait;
+		wait.tv_sec = timeout / NANOS_PER_SECOND;
+		wait.tv_nsec = timeout % NANOS_PER_SECOND;
+		
+		int signal = sigtimedwait(&signals, NULL, &wait);
+		
+		if (!isReporting) break;
+		
+		if (signal == SIGUSR1)
+		{
+			reportMetrics("SIGUSR1");
+		}
+		else if (signal == SIGINT || signal == SIGTERM)
+		{
+			// run() makes the exit report once the loops return, and the reporter keeps waiting until then
+			LOG(LOG_LEVEL_INFO, "Stopping on %s\n", (signal == SIGINT) ? "SIGINT" : "SIGTERM");
+			
+			stopSignal = signal;
+			
+			for (size_t i = 0; i < loops.size(); i++)
+			{
+				loops[i]->stop();
+			}
+		}
+		else if (reportInterval > 0 && monotonicNow() >= nextReport)
+		{
+			reportMetrics("periodic");
+			nextReport += reportInterval;
+			
+			// Don't try to catch up on the reports missed while the process was stopped
+			if (nextReport < monotonicNow()) nextReport = monotonicNow() + reportInterval;
+		}
+	}
+}
+
+
+void Swarm::reportMetrics(const char* reason)
+{
+	// The loops keep running, so the merged metrics may be a few events apart from each other
+	Metrics* total = new Metrics();
+	
+	for (size_t i = 0; i < loops.size(); i++)
+	{
+		total->add(loops[i]->getMetrics());
+	}
+	
+	int64_t now = monotonicNow();
+	double seconds = nanosToSeconds(now - lastReportTime);
+	
+	LOG(LOG_LEVEL_INFO, "Metrics (%s), message rates over the last %.1f s:\n", reason, seconds);
+	
+	for (int i = 0; i < NUM_LATENCIES; i++)
+	{
+		const LatencyHistogram& latency = total->getLatency(i);
+		
+		LOG(LOG_LEVEL_INFO, "  %s latency (us): count %llu, mean %.1f, p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+				Metrics::getLatencyName(i), (unsigned long long)latency.getCount(),
+				latency.getMean() / NANOS_PER_MICROSECOND,
+				latency.getPercentile(50) / (double)NANOS_PER_MICROSECOND,
+				latency.getPercentile(90) / (double)NANOS_PER_MICROSECOND,
+				latency.getPercentile(99) / (double)NANOS_PER_MICROSECOND,
+				latency.getPercentile(99.9) / (double)NANOS_PER_MICROSECOND,
+				latency.getMax() / (double)NANOS_PER_MICROSECOND);
+	}
+	
+	for (int code = 0; code < NUM_MESSAGE_CODES; code++)
+	{
+		uint64_t numMessages = total->getNumMessages(code);
+		uint64_t numBytes = total->getNumBytes(code);
+		
+		// Frames with an unknown code are only reported if there are any
+		if (code == 0 && numMessages == 0) continue;
+		
+		double messageRate = (seconds > 0) ? (numMessages - lastNumMessages[code]) / seconds : 0;
+		double byteRate = (seconds > 0) ? (numBytes - lastNumBytes[code]) / seconds : 0;
+		
+		LOG(LOG_LEVEL_INFO, "  %s (%d): %llu messages, %llu bytes, %.1f messages/s, %.1f bytes/s\n",
+				Metrics::getMessageName(code), code, (unsigned long long)numMessages, (unsigned long long)numBytes, messageRate, byteRate);
+		
+		lastNumMessages[code] = numMessages;
+		lastNumBytes[code] = numBytes;
+	}
+	
+	LOG(LOG_LEVEL_INFO, "  map updates decoded: %llu, shared between clients: %llu\n",
+			(unsigned long long)total->getNumMapUpdatesDecoded(), (unsigned long long)total->getNumMapUpdatesShared());
+	
+	lastReportTime = now;
+	
+	delete total;
+}
@@ -0,0 +1,85 @@
+#ifndef SWARM_H
+#define SWARM_H
+
+#include <vector>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <signal.h>
+#include <atomic>
+#include "EventLoop.h"
+#include "PlayerClient.h"
+#include "ProximityKernel.h"
+#include "SharedWorld.h"
+#include "DecisionPool.h"
+#include "Metrics.h"
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ * 
+ * A swarm hosts many player clients in a single process, so that a game server can be load-tested by a few processes.
+ * Each client keeps its own connection and its own bot, while the map updates are decoded once into a world model shared by all bots.
+ * The clients are sharded round-robin across several event loops, and each event loop runs on its own thread.
+ * By default there is one event loop per core, and the thread of each event loop is pinned to its core.
+ * Optionally, the decisions of the bots are taken by a separate pool of threads, so that the event loops only do the network I/O.
+ * 
+ * The metrics of the event loops are merged and reported periodically, on SIGUSR1, and once all connections are closed.
+ * SIGINT and SIGTERM stop the event loops, so the last report is made even though connections are still open.
+ * A reporter thread waits for these signals synchronously, so they must be blocked in every thread of the process (see main).
+ * 
+ *********************************************************************************************************************************************/
+
+class Swarm
+{
+	private:
+	
+		vector<EventLoop*> loops;
+		vector<PlayerClient*> clients;
+		SharedWorld world; // map updates decoded once for all the clients
+		DecisionPool* decisionPool; // threads taking the decisions of the bots, or NULL if the bots decide on the event loops
+		
+		// Reports of the metrics
+		thread reporter;
+		atomic<bool> isReporting;
+		atomic<int> stopSignal; // SIGINT or SIGTERM once received, or 0
+		int64_t reportInterval; // time between two periodic reports, in nanoseconds (0 if there are none)
+		int64_t lastReportTime; // monotonic time of the last report, in nanoseconds
+		uint64_t lastNumMessages[NUM_MESSAGE_CODES]; // message counts at the last report, for the rates
+		uint64_t lastNumBytes[NUM_MESSAGE_CODES];
+		
+		// Raise the limit on open file descriptors, since each client needs a socket
+		void raiseFileLimit();
+		
+		// Run the event loop on the current thread, pinned to the given core (not pinned if core is -1)
+		static void runLoop(EventLoop* loop, int core);
+		
+		// Report the metrics periodically and on SIGUSR1, and stop the loops on SIGINT or SIGTERM, until isReporting is cleared
+		void runReporter();
+		
+		// Log the metrics of all the loops, with the message rates since the last report
+		void reportMetrics(const char* reason);
+		
+	public:
+	
+		// Create numBots player clients connected to the server at the host name and port number
+		// The clients are distributed across numLoops event loops
+		// If numLoops is 0, there is one event loop per core
+		// If numWorkers is not 0, the bots decide on a pool of numWorkers threads instead of on the event loops
+		// If decisionSlack is not negative, the bots act right after map updates (see PlayerClient)
+		// If reportInterval is not 0, the metrics are reported every reportInterval nanoseconds
+		Swarm(const char* serverHostName, const char* serverPortNum, int botAIType, int numBots, int numLoops, int numWorkers = 0, int64_t decisionSlack = -1,
+				int64_t reportInterval = 0);
+		
+		~Swarm();
+		
+		// Run all event loops until all connections are closed, or until SIGINT or SIGTERM is received
+		void run();
+		
+		// Get the signal that stopped the swarm, or 0 if all its connections were closed
+		int getStopSignal();
+};
+
+#endif
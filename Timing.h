@@ -0,0 +1,45 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+#include <time.h>
+
+
+/********************************************************************************************************************************************
+ * 
+ * Timing of the bots and the event loops.
+ * 
+ * All times are int64 nanoseconds of the monotonic clock (CLOCK_MONOTONIC), the steady clock that epoll timeouts are based on.
+ * Unlike clock(), it keeps running while the process is idle, and unlike the wall clock, it never jumps.
+ * 64 bits of nanoseconds are exact over centuries of uptime, while a double of seconds loses nanosecond precision after a few months.
+ * 
+ *********************************************************************************************************************************************/
+
+#define NANOS_PER_SECOND		1000000000LL
+#define NANOS_PER_MILLISECOND	1000000LL
+#define NANOS_PER_MICROSECOND	1000LL
+
+
+// Get the current time of the monotonic clock, in nanoseconds
+inline int64_t monotonicNow()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return (int64_t)now.tv_sec * NANOS_PER_SECOND + now.tv_nsec;
+}
+
+
+inline int64_t secondsToNanos(double seconds)
+{
+	return (int64_t)(seconds * NANOS_PER_SECOND);
+}
+
+
+inline double nanosToSeconds(int64_t nanos)
+{
+	return nanos / (double)NANOS_PER_SECOND;
+}
+
+
+#endif
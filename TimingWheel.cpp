@@ -0,0 +1,241 @@
+#include "TimingWheel.h"
+#include <string.h>
+
+
+TimingWheel::TimingWheel()
+{
+	memset(slots, 0, sizeof(slots));
+	memset(occupied, 0, sizeof(occupied));
+	
+	currentTick = monotonicNow() / TIMING_WHEEL_TICK_NANOS;
+	numTimers = 0;
+}
+
+
+void TimingWheel::place(WheelTimer* timer)
+{
+	// An overdue timer expires at the next tick
+	int64_t tick = (timer->tick < currentTick) ? currentTick : timer->tick;
+	
+	// Find the lowest level whose current rotation holds the tick
+	// The slot is never the current slot of the level, unless the level is 0, since the tick would then be held by a lower level
+	int level = 0;
+	
+	while (level < TIMING_WHEEL_LEVELS - 1 && (tick >> (level * TIMING_WHEEL_BITS)) - (currentTick >> (level * TIMING_WHEEL_BITS)) >= TIMING_WHEEL_SLOTS)
+	{
+		level++;
+	}
+	
+	int64_t span = tick >> (level * TIMING_WHEEL_BITS);
+	
+	// Past the span of the wheel, the timer waits in the last slot of the top level, and is placed again when it is cascaded
+	if (span - (currentTick >> (level * TIMING_WHEEL_BITS)) >= TIMING_WHEEL_SLOTS)
+	{
+		span = (currentTick >> (level * TIMING_WHEEL_BITS)) + TIMING_WHEEL_SLOTS - 1;
+	}
+	
+	uint32_t index = span & TIMING_WHEEL_MASK;
+	
+	timer->level = level;
+	timer->index = index;
+	timer->prev = NULL;
+	timer->next = slots[level][index];
+	
+	if (timer->next != NULL) timer->next->prev = timer;
+	
+	slots[level][index] = timer;
+	occupied[level][index >> 6] |= (uint64_t)1 << (index & 63);
+}
+
+
+void TimingWheel::unlink(WheelTimer* timer)
+{
+	if (timer->prev != NULL)
+	{
+		timer->prev->next = timer->next;
+	}
+	else
+	{
+		// The timer is the head of its slot
+		slots[timer->level][timer->index] = timer->next;
+		
+		if (timer->next == NULL) occupied[timer->level][timer->index >> 6] &= ~((uint64_t)1 << (timer->index & 63));
+	}
+	
+	if (timer->next != NULL) timer->next->prev = timer->prev;
+	
+	timer->level = -1;
+	timer->prev = NULL;
+	timer->next = NULL;
+}
+
+
+void TimingWheel::schedule(WheelTimer* timer, int64_t deadline)
+{
+	// Round up, so that the timer never expires before its deadline
+	int64_t tick = (deadline + TIMING_WHEEL_TICK_NANOS - 1) / TIMING_WHEEL_TICK_NANOS;
+	
+	if (isScheduled(timer))
+	{
+		// Most reschedules are to the same deadline
+		if (timer->tick == tick) return;
+		
+		unlink(timer);
+		numTimers--;
+	}
+	
+	timer->tick = tick;
+	place(timer);
+	numTimers++;
+}
+
+
+void TimingWheel::cancel(WheelTimer* timer)
+{
+	if (!isScheduled(timer)) return;
+	
+	unlink(timer);
+	numTimers--;
+}
+
+
+bool TimingWheel::isScheduled(const WheelTimer* timer)
+{
+	return timer->level != -1;
+}
+
+
+void TimingWheel::cascade()
+{
+	for (int level = 1; level < TIMING_WHEEL_LEVELS; level++)
+	{
+		uint32_t index = (currentTick >> (level * TIMING_WHEEL_BITS)) & TIMING_WHEEL_MASK;
+		
+		WheelTimer* timer = slots[level][index];
+		
+		slots[level][index] = NULL;
+		occupied[level][index >> 6] &= ~((uint64_t)1 << (index & 63));
+		
+		// Place the timers again, relative to the new current tick
+		while (timer != NULL)
+		{
+			WheelTimer* next = timer->next;
+			
+			place(timer);
+			timer = next;
+		}
+		
+		// The span of the next level only starts if this level wrapped around
+		if (index != 0) break;
+	}
+}
+
+
+int32_t TimingWheel::findOccupied(int level, uint32_t index) const
+{
+	const uint64_t* bits = occupied[level];
+	
+	// Look from index to the end of the level, then from the start of the level to index
+	for (uint32_t distance = 0; distance < TIMING_WHEEL_SLOTS + 64; )
+	{
+		uint32_t position = (index + distance) & TIMING_WHEEL_MASK;
+		uint64_t word = bits[position >> 6] >> (position & 63);
+		
+		if (word != 0)
+		{
+			distance += __builtin_ctzll(word);
+			
+			return (distance < TIMING_WHEEL_SLOTS) ? (int32_t)distance : -1;
+		}
+		
+		// Move to the start of the next word
+		distance += 64 - (position & 63);
+	}
+	
+	return -1;
+}
+
+
+WheelTimer* TimingWheel::advance(int64_t now)
+{
+	WheelTimer* expired = NULL;
+	int64_t nowTick = now / TIMING_WHEEL_TICK_NANOS;
+	
+	while (currentTick <= nowTick)
+	{
+		uint32_t index = currentTick & TIMING_WHEEL_MASK;
+		
+		// Entering the span of a new slot of level 1
+		if (index == 0) cascade();
+		
+		WheelTimer* timer = slots[0][index];
+		
+		slots[0][index] = NULL;
+		occupied[0][index >> 6] &= ~((uint64_t)1 << (index & 63));
+		
+		// Move the timers of the slot to the expired list
+		while (timer != NULL)
+		{
+			WheelTimer* next = timer->next;
+			
+			timer->level = -1;
+			timer->prev = NULL;
+			timer->next = expired;
+			expired = timer;
+			numTimers--;
+			
+			timer = next;
+		}
+		
+		currentTick++;
+		
+		// Skip the empty slots up to the next occupied slot or the end of the rotation, where the next cascade happens
+		index = currentTick & TIMING_WHEEL_MASK;
+		
+		if (index != 0)
+		{
+			int32_t distance = findOccupied(0, index);
+			
+			if (distance == -1 || index + distance >= TIMING_WHEEL_SLOTS) distance = TIMING_WHEEL_SLOTS - index;
+			
+			int64_t next = currentTick + distance;
+			
+			currentTick = (next <= nowTick) ? next : nowTick + 1;
+		}
+	}
+	
+	return expired;
+}
+
+
+int64_t TimingWheel::getNextWakeup() const
+{
+	if (numTimers == 0) return -1;
+	
+	int64_t wakeup = -1;
+	
+	for (int level = 0; level < TIMING_WHEEL_LEVELS; level++)
+	{
+		int shift = level * TIMING_WHEEL_BITS;
+		uint32_t index = (currentTick >> shift) & TIMING_WHEEL_MASK;
+		
+		// Past level 0, the current slot is empty once its timers are cascaded
+		// They are still there if the current tick is the start of its span, since the cascade happens when that tick is expired
+		bool isCascaded = (level > 0) && (currentTick & (((int64_t)1 << shift) - 1)) != 0;
+		
+		int32_t distance = isCascaded ? findOccupied(level, (index + 1) & TIMING_WHEEL_MASK) : findOccupied(level, index);
+		
+		if (distance == -1) continue;
+		
+		if (isCascaded) distance++;
+		
+		// The tick at which the slot expires (level 0) or is cascaded (higher levels)
+		int64_t tick = ((currentTick >> shift) + distance) << shift;
+		
+		if (tick < currentTick) tick = currentTick;
+		
+		if (wakeup == -1 || tick < wakeup) wakeup = tick;
+	}
+	
+	return wakeup * TIMING_WHEEL_TICK_NANOS;
+}
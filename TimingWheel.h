@@ -0,0 +1,99 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <stdint.h>
+#include "Timing.h"
+
+// Resolution of the wheel, in nanoseconds
+#define TIMING_WHEEL_TICK_NANOS		NANOS_PER_MILLISECOND
+
+// Each level of the wheel has 2^TIMING_WHEEL_BITS slots
+#define TIMING_WHEEL_BITS			8
+#define TIMING_WHEEL_SLOTS			(1 << TIMING_WHEEL_BITS)
+#define TIMING_WHEEL_MASK			(TIMING_WHEEL_SLOTS - 1)
+
+// With 4 levels of 256 slots of 1 ms, the wheel spans 2^32 ms (about 49 days)
+#define TIMING_WHEEL_LEVELS			4
+
+using namespace std;
+
+
+struct EventSource;
+
+
+// A timer scheduled on a timing wheel
+// The timer is embedded in its owner, so scheduling and cancelling it never allocates
+struct WheelTimer
+{
+	WheelTimer* prev;
+	WheelTimer* next;
+	int64_t tick; // tick at which the timer expires
+	int level; // level of the slot holding the timer, or -1 if the timer is not scheduled
+	uint32_t index; // index of the slot holding the timer in its level
+	EventSource* source; // the event source to notify when the timer expires
+};
+
+
+/********************************************************************************************************************************************
+ * 
+ * Hierarchical timing wheel, used by an event loop to schedule the actions of its bots.
+ * 
+ * Level 0 has one slot per tick for the next 256 ticks. Each slot of level L spans 256 slots of level L - 1,
+ * and its timers are moved down to level L - 1 (cascaded) when the current tick enters the span of the slot.
+ * Scheduling and cancelling a timer are O(1), and each timer is cascaded at most once per level.
+ * A bitmap of the occupied slots of each level lets the wheel skip empty slots, and find the next time it needs to be advanced,
+ * which the event loop uses as its epoll timeout. Bots that are cooling down cost nothing until their timer expires.
+ * 
+ * Timers never expire before their deadline, and expire at most one tick after it.
+ * 
+ *********************************************************************************************************************************************/
+
+class TimingWheel
+{
+	private:
+	
+		WheelTimer* slots[TIMING_WHEEL_LEVELS][TIMING_WHEEL_SLOTS]; // head of the list of timers of each slot
+		uint64_t occupied[TIMING_WHEEL_LEVELS][TIMING_WHEEL_SLOTS / 64]; // bit set for each slot holding timers
+		int64_t currentTick; // the next tick to expire
+		uint32_t numTimers;
+		
+		// Add a timer to the slot of its tick, relative to the current tick
+		void place(WheelTimer* timer);
+		
+		// Remove a timer from its slot
+		void unlink(WheelTimer* timer);
+		
+		// Move the timers of the slots whose span starts at the current tick down to the lower levels
+		void cascade();
+		
+		// Get the number of slots from the slot at index to the next occupied slot of a level, wrapping around
+		// Return -1 if the level is empty
+		int32_t findOccupied(int level, uint32_t index) const;
+		
+	public:
+	
+		// Create an empty wheel starting at the current time
+		TimingWheel();
+		
+		// Schedule a timer to expire at the given monotonic time, in nanoseconds
+		// A timer that is already scheduled is moved to its new deadline
+		void schedule(WheelTimer* timer, int64_t deadline);
+		
+		// Cancel a timer if it is scheduled
+		void cancel(WheelTimer* timer);
+		
+		// Determine if a timer is scheduled
+		static bool isScheduled(const WheelTimer* timer);
+		
+		// Advance the wheel up to the given monotonic time, in nanoseconds
+		// Return the list of the timers that expired, linked by their next pointer, or NULL if none did
+		// The expired timers are no longer scheduled, and can be scheduled again right away
+		WheelTimer* advance(int64_t now);
+		
+		// Get the monotonic time at which the wheel next needs to be advanced, in nanoseconds
+		// This is the deadline of the next timer, or the start of the span of the next slot to cascade
+		// Return -1 if no timer is scheduled
+		int64_t getNextWakeup() const;
+};
+
+#endif
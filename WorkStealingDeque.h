@@ -0,0 +1,132 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+using namespace std;
+
+
+/********************************************************************************************************************************************
+ *
+ * Bounded lock-free work-stealing deque (Chase-Lev), holding pointers.
+ *
+ * The owner thread pushes and pops items at the bottom, like a stack, so it keeps working on the items it queued last.
+ * Other threads steal items from the top, the oldest ones, which only contend with the owner when a single item is left.
+ * Both ends are indices that only grow, and the items live in a ring indexed by them,
+ * so the owner's pushes and pops never touch the top except to settle the race for the last item.
+ *
+ * The deque never allocates after construction, so pushing fails when it is full.
+ * The capacity is rounded up to a power of 2.
+ *
+ *********************************************************************************************************************************************/
+
+template <typename T>
+class WorkStealingDeque
+{
+	private:
+		
+		vector<atomic<T*> > cells;
+		int64_t mask; // number of cells - 1
+		
+		atomic<int64_t> top; // index of the oldest item, advanced by the thieves (and by the owner for the last item)
+		char padding[64]; // keeps the owner and the thieves on separate cache lines
+		atomic<int64_t> bottom; // index after the newest item, only written by the owner
+	
+	public:
+		
+		// Create a deque that holds at least capacity items
+		WorkStealingDeque(uint32_t capacity) : cells(roundCapacity(capacity))
+		{
+			mask = cells.size() - 1;
+			
+			for (size_t i = 0; i < cells.size(); i++)
+			{
+				cells[i].store(NULL, memory_order_relaxed);
+			}
+			
+			top.store(0, memory_order_relaxed);
+			bottom.store(0, memory_order_relaxed);
+		}
+		
+		// Get the number of cells needed for the capacity
+		static uint32_t roundCapacity(uint32_t capacity)
+		{
+			uint32_t size = 2;
+			
+			while (size < capacity) size <<= 1;
+			
+			return size;
+		}
+		
+		// Add an item at the bottom, only from the owner thread
+		// Return false if the deque is full
+		bool push(T* item)
+		{
+			int64_t b = bottom.load(memory_order_relaxed);
+			int64_t t = top.load(memory_order_acquire);
+			
+			if (b - t > mask) return false;
+			
+			cells[b & mask].store(item, memory_order_relaxed);
+			
+			// Publish the item before the new bottom
+			atomic_thread_fence(memory_order_release);
+			bottom.store(b + 1, memory_order_relaxed);
+			
+			return true;
+		}
+		
+		// Take the newest item, only from the owner thread
+		// Return NULL if the deque is empty
+		T* pop()
+		{
+			int64_t b = bottom.load(memory_order_relaxed) - 1;
+			
+			// Reserve the bottom item before looking at the top, so that a thief can't take it as well
+			bottom.store(b, memory_order_relaxed);
+			atomic_thread_fence(memory_order_seq_cst);
+			
+			int64_t t = top.load(memory_order_relaxed);
+			
+			if (t > b)
+			{
+				// Empty
+				bottom.store(b + 1, memory_order_relaxed);
+				return NULL;
+			}
+			
+			T* item = cells[b & mask].load(memory_order_relaxed);
+			
+			if (t == b)
+			{
+				// The last item, which a thief may be taking at the same time
+				if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) item = NULL;
+				
+				bottom.store(b + 1, memory_order_relaxed);
+			}
+			
+			return item;
+		}
+		
+		// Take the oldest item, from any thread
+		// Return NULL if the deque is empty or if another thread took the item first
+		T* steal()
+		{
+			int64_t t = top.load(memory_order_acquire);
+			atomic_thread_fence(memory_order_seq_cst);
+			int64_t b = bottom.load(memory_order_acquire);
+			
+			if (t >= b) return NULL;
+			
+			T* item = cells[t & mask].load(memory_order_relaxed);
+			
+			if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) return NULL;
+			
+			return item;
+		}
+};
+
+#endif
@@ -1,24 +1,108 @@
 #include <cstdlib>
+#include <unistd.h>
 #include "PlayerClient.h"
+#include "Swarm.h"
 
 
-int main(int argc, const char* argv[])
+int main(int argc, char* argv[])
 {
-	// 3 argument is expected for hostname, portnum, and bot type apart from the program name
-	if (argc != 4)
+	int numBots = 1;
+	int numLoops = 0;
+	int numWorkers = 0;
+	int64_t decisionSlack = -1;
+	int logLevel = LOG_LEVEL_INFO;
+	int64_t reportInterval = 10 * NANOS_PER_SECOND;
+	uint64_t masterSeed = (uint64_t)time(NULL);
+	int opt;
+	
+	// Parse the options for swarm mode
+	// -n: number of bots hosted by the process
+	// -t: number of event loop threads (one per core by default)
+	// -w: number of threads taking the bots' decisions, apart from the event loops (none by default)
+	// -s: master seed of the bots' random generators (the current time by default), to reproduce a run
+	// -a: schedule the bots' actions right after map updates, waiting up to the given number of milliseconds past the cooldown for one
+	// -l: highest level of the log records written (0: errors, 1: warnings, 2: info, the default, 3: debug, with every action)
+	// -m: number of seconds between two reports of the metrics (10 by default, 0 for none but on SIGUSR1 and at exit)
+	while ((opt = getopt(argc, argv, "n:t:w:a:s:l:m:")) != -1)
+	{
+		switch(opt)
+		{
+			case 'n':
+				numBots = atoi(optarg);
+				break;
+				
+			case 't':
+				numLoops = atoi(optarg);
+				break;
+				
+			case 'w':
+				numWorkers = atoi(optarg);
+				break;
+				
+			case 's':
+				masterSeed = strtoull(optarg, NULL, 0);
+				break;
+				
+			case 'a':
+				decisionSlack = (int64_t)(atof(optarg) * NANOS_PER_MILLISECOND);
+				break;
+				
+			case 'l':
+				logLevel = atoi(optarg);
+				break;
+				
+			case 'm':
+				reportInterval = secondsToNanos(atof(optarg));
+				break;
+				
+			default:
+				fprintf(stdout, "Format: './client [-n number of bots] [-t number of threads] [-w number of decision threads] [-a slack in ms] [-s seed] [-l log level] [-m report interval in s] [hostname] [portnum] [bot type]'\n");
+				return 0;
+		}
+	}
+	
+	// 3 argument is expected for hostname, portnum, and bot type apart from the program name and options
+	if (argc - optind != 3 || numBots < 1)
 	{
 		fprintf(stderr, "Wrong number of arguments\n");
-		fprintf(stdout, "Format: './client [hostname] [portnum] [bot type]'\n");
+		fprintf(stdout, "Format: './client [-n number of bots] [-t number of threads] [-w number of decision threads] [-a slack in ms] [-s seed] [-l log level] [-m report interval in s] [hostname] [portnum] [bot type]'\n");
 		return 0;
 	}
 	
+	const char* hostName = argv[optind];
+	const char* portNum = argv[optind + 1];
+	
 	// Parse the argument into AI type code
-	int AIType = atoi(argv[3]);
+	int AIType = atoi(argv[optind + 2]);
+	
+	// SIGUSR1 triggers a report of the metrics, and SIGINT and SIGTERM stop the swarm, and they are only taken by the reporter of the swarm
+	// They are blocked before any thread is started, so that every thread inherits the mask and the signals never kill the process
+	// before the final report and the log are written out
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGUSR1);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+	
+	Log::setLevel(logLevel);
+	Log::start();
+	
+	// The seed is printed so that the run can be reproduced
+	LOG(LOG_LEVEL_INFO, "Master seed: %llu\n", (unsigned long long)masterSeed);
+	Bot::setMasterSeed(masterSeed);
 	
 	// Set host to "127.0.0.1" to test client and server on same machine
-	PlayerClient* playerClient = new PlayerClient(argv[1], argv[2], AIType);
+	Swarm* swarm = new Swarm(hostName, portNum, AIType, numBots, numLoops, numWorkers, decisionSlack, reportInterval);
+	
+	swarm->run();
+	
+	int stopSignal = swarm->getStopSignal();
+	
+	delete swarm;
 	
-	playerClient->run();
+	Log::stop();
 	
-	return 0;
+	// Exit with the status of a process killed by the signal, as the shell would report it
+	return (stopSignal != 0) ? 128 + stopSignal : 0;
 }